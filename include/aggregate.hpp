@@ -0,0 +1,229 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__) && !defined(FINCALC_SCALAR_AGGREGATE)
+#include <immintrin.h>
+#define FINCALC_AVX2_AGGREGATE 1
+#else
+#define FINCALC_AVX2_AGGREGATE 0
+#endif
+
+// count / sum / min / max of some values; mean() is the average
+struct Summary
+{
+    std::size_t count = 0;
+    double sum = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double v)
+    {
+        ++count;
+        sum += v;
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+    }
+
+    double mean() const { return count ? sum / count : 0.0; }
+};
+
+// ---------------------------------------------------------
+// Aggregates over the columns of a LoanTable / DepositTable /
+// CreditTable. over() is one pass with eight running sums, mins and
+// maxes, two AVX2 registers of each (-DFINCALC_SCALAR_AGGREGATE for
+// the plain loop), so the sum is added in a different order than a
+// plain loop and may differ from it in the last bits. groupBy() is one
+// pass over a key column and a value column; integer keys that span
+// fewer than DENSE_SPAN values go straight to a slot per key, others
+// binary-search a short sorted list of the keys seen so far.
+// ---------------------------------------------------------
+namespace Aggregate
+{
+    constexpr std::size_t DENSE_SPAN = 1 << 16;
+
+    template <typename K>
+    struct Group
+    {
+        K key;
+        Summary summary;
+    };
+
+    inline Summary over(const double *v, std::size_t n)
+    {
+        Summary s;
+        std::size_t i = 0;
+#if FINCALC_AVX2_AGGREGATE
+        if (n >= 8)
+        {
+            __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+            __m256d min0 = _mm256_set1_pd(s.min), min1 = min0;
+            __m256d max0 = _mm256_set1_pd(s.max), max1 = max0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256d a = _mm256_loadu_pd(v + i), b = _mm256_loadu_pd(v + i + 4);
+                sum0 = _mm256_add_pd(sum0, a);
+                sum1 = _mm256_add_pd(sum1, b);
+                min0 = _mm256_min_pd(min0, a);
+                min1 = _mm256_min_pd(min1, b);
+                max0 = _mm256_max_pd(max0, a);
+                max1 = _mm256_max_pd(max1, b);
+            }
+            double lanes[4];
+            _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+            s.sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            _mm256_storeu_pd(lanes, _mm256_min_pd(min0, min1));
+            s.min = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+            _mm256_storeu_pd(lanes, _mm256_max_pd(max0, max1));
+            s.max = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+            s.count = i;
+        }
+#endif
+        for (; i < n; ++i)
+            s.add(v[i]);
+        return s;
+    }
+
+    inline Summary over(const std::vector<double> &column)
+    {
+        return over(column.data(), column.size());
+    }
+
+    // out = one Summary of values per distinct key, sorted by key
+    template <typename K>
+    void groupBy(const std::vector<K> &keys, const std::vector<double> &values, std::vector<Group<K>> &out)
+    {
+        out.clear();
+        std::size_t n = std::min(keys.size(), values.size());
+        if (n == 0)
+            return;
+
+        if constexpr (std::is_integral_v<K>)
+        {
+            auto [lo, hi] = std::minmax_element(keys.begin(), keys.begin() + n);
+            if (static_cast<double>(*hi) - static_cast<double>(*lo) < DENSE_SPAN)
+            {
+                K base = *lo;
+                std::vector<Summary> slots(static_cast<std::size_t>(*hi - base) + 1);
+                for (std::size_t i = 0; i < n; ++i)
+                    slots[static_cast<std::size_t>(keys[i] - base)].add(values[i]);
+                for (std::size_t k = 0; k < slots.size(); ++k)
+                    if (slots[k].count)
+                        out.push_back(Group<K>{static_cast<K>(base + static_cast<K>(k)), slots[k]});
+                return;
+            }
+        }
+
+        std::size_t last = 0; // slot of the previous row's key: runs of one key skip the search
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const K &key = keys[i];
+            if (out.empty() || out[last].key < key || key < out[last].key)
+            {
+                auto at = std::lower_bound(out.begin(), out.end(), key, [](const Group<K> &g, const K &k)
+                                           { return g.key < k; });
+                if (at == out.end() || key < at->key)
+                    at = out.insert(at, Group<K>{key, Summary()});
+                last = static_cast<std::size_t>(at - out.begin());
+            }
+            out[last].summary.add(values[i]);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// RunningTotals<K> : count and sum of one value field, overall and per
+// key of a grouping field (a tenure, say), kept current as records are
+// added, updated and deleted, so a dashboard reads a total or an
+// average in O(1) and every group in O(groups) without touching the
+// records. Min and max can't be taken back out on a delete; they come
+// from the field's RangeIndex. Sums are added and taken back out, so
+// they can pick up rounding after many edits; every rebuildAll starts
+// them fresh.
+// ---------------------------------------------------------
+template <typename K>
+class RunningTotals
+{
+    std::vector<K> keys; // sorted, distinct
+    std::vector<std::size_t> counts;
+    std::vector<double> sums;
+    std::size_t count_ = 0;
+    double sum_ = 0;
+
+    std::size_t slotFor(const K &key) const
+    {
+        return static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+
+public:
+    template <typename Data, typename KeyOf, typename ValueOf>
+    void build(const std::vector<Data> &data, KeyOf keyOf, ValueOf valueOf)
+    {
+        clear();
+        for (const Data &d : data)
+            add(keyOf(d), valueOf(d));
+    }
+
+    void add(const K &key, double value)
+    {
+        std::size_t at = slotFor(key);
+        if (at == keys.size() || key < keys[at] || keys[at] < key)
+        {
+            keys.insert(keys.begin() + at, key);
+            counts.insert(counts.begin() + at, 0);
+            sums.insert(sums.begin() + at, 0.0);
+        }
+        ++counts[at];
+        sums[at] += value;
+        ++count_;
+        sum_ += value;
+    }
+
+    bool remove(const K &key, double value)
+    {
+        std::size_t at = slotFor(key);
+        if (at == keys.size() || key < keys[at] || keys[at] < key)
+            return false;
+        --count_;
+        sum_ = count_ ? sum_ - value : 0.0;
+        if (--counts[at] == 0)
+        {
+            keys.erase(keys.begin() + at);
+            counts.erase(counts.begin() + at);
+            sums.erase(sums.begin() + at);
+        }
+        else
+            sums[at] -= value;
+        return true;
+    }
+
+    std::size_t count() const { return count_; }
+    double sum() const { return sum_; }
+    double mean() const { return count_ ? sum_ / count_ : 0.0; }
+
+    // groups in key order
+    std::size_t groups() const { return keys.size(); }
+    const K &key(std::size_t g) const { return keys[g]; }
+    std::size_t count(std::size_t g) const { return counts[g]; }
+    double sum(std::size_t g) const { return sums[g]; }
+    double mean(std::size_t g) const { return sums[g] / counts[g]; }
+
+    // group of key, or groups() when no record has it
+    std::size_t find(const K &key) const
+    {
+        std::size_t at = slotFor(key);
+        return at < keys.size() && !(key < keys[at]) && !(keys[at] < key) ? at : keys.size();
+    }
+
+    void clear()
+    {
+        keys.clear();
+        counts.clear();
+        sums.clear();
+        count_ = 0;
+        sum_ = 0;
+    }
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
 
 struct CreditRecord
 {
@@ -18,7 +19,99 @@ namespace CreditSort
     inline bool byMonths(const CreditRecord &a, const CreditRecord &b) { return a.months < b.months; }
 }
 
+// columnar (struct-of-arrays) copy of a credit book: one contiguous
+// vector per field, so a scan over one numeric field doesn't drag the
+// names through the cache. Row i of every column is record i.
+struct CreditTable
+{
+    std::vector<std::string> name;
+    std::vector<double> amount;
+    std::vector<double> interest;
+    std::vector<int> months;
+
+    std::size_t size() const { return name.size(); }
+    bool empty() const { return name.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        name.reserve(n);
+        amount.reserve(n);
+        interest.reserve(n);
+        months.reserve(n);
+    }
+
+    void clear()
+    {
+        name.clear();
+        amount.clear();
+        interest.clear();
+        months.clear();
+    }
+
+    void push(const CreditRecord &c)
+    {
+        name.push_back(c.name);
+        amount.push_back(c.amount);
+        interest.push_back(c.interest);
+        months.push_back(c.months);
+    }
+
+    CreditRecord row(std::size_t i) const
+    {
+        CreditRecord c;
+        c.name = name[i];
+        c.amount = amount[i];
+        c.interest = interest[i];
+        c.months = months[i];
+        return c;
+    }
+
+    void set(std::size_t i, const CreditRecord &c)
+    {
+        name[i] = c.name;
+        amount[i] = c.amount;
+        interest[i] = c.interest;
+        months[i] = c.months;
+    }
+
+    // swap-and-pop, same as the menus do on the record vector
+    void removeAt(std::size_t i)
+    {
+        name[i] = std::move(name.back());
+        amount[i] = std::move(amount.back());
+        interest[i] = std::move(interest.back());
+        months[i] = std::move(months.back());
+        name.pop_back();
+        amount.pop_back();
+        interest.pop_back();
+        months.pop_back();
+    }
+
+    static CreditTable from(const std::vector<CreditRecord> &records)
+    {
+        CreditTable t;
+        t.reserve(records.size());
+        for (const auto &c : records)
+            t.push(c);
+        return t;
+    }
+
+    std::vector<CreditRecord> records() const
+    {
+        std::vector<CreditRecord> out(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            out[i] = row(i);
+        return out;
+    }
+};
+
 namespace Credits
 {
     void showMenu();
+    double calcTotal(const CreditRecord &c);
+    double calcMonthly(const CreditRecord &c);
+
+    // column versions: out[i] is the result for row i
+    void calcTotal(const CreditTable &t, std::vector<double> &out);
+    void calcMonthly(const CreditTable &t, std::vector<double> &out);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
 
 struct Deposit
 {
@@ -27,11 +28,101 @@ namespace DepositSort
     inline bool byMonths(const Deposit &a, const Deposit &b) { return a.months < b.months; }
 }
 
+// columnar (struct-of-arrays) copy of a deposit book: one contiguous
+// vector per field, so a scan over one numeric field doesn't drag the
+// names through the cache. Row i of every column is record i.
+struct DepositTable
+{
+    std::vector<std::string> name;
+    std::vector<double> amount;
+    std::vector<double> rate;
+    std::vector<int> months;
+
+    std::size_t size() const { return name.size(); }
+    bool empty() const { return name.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        name.reserve(n);
+        amount.reserve(n);
+        rate.reserve(n);
+        months.reserve(n);
+    }
+
+    void clear()
+    {
+        name.clear();
+        amount.clear();
+        rate.clear();
+        months.clear();
+    }
+
+    void push(const Deposit &d)
+    {
+        name.push_back(d.name);
+        amount.push_back(d.amount);
+        rate.push_back(d.rate);
+        months.push_back(d.months);
+    }
+
+    Deposit row(std::size_t i) const
+    {
+        Deposit d;
+        d.name = name[i];
+        d.amount = amount[i];
+        d.rate = rate[i];
+        d.months = months[i];
+        return d;
+    }
+
+    void set(std::size_t i, const Deposit &d)
+    {
+        name[i] = d.name;
+        amount[i] = d.amount;
+        rate[i] = d.rate;
+        months[i] = d.months;
+    }
+
+    // swap-and-pop, same as the menus do on the record vector
+    void removeAt(std::size_t i)
+    {
+        name[i] = std::move(name.back());
+        amount[i] = std::move(amount.back());
+        rate[i] = std::move(rate.back());
+        months[i] = std::move(months.back());
+        name.pop_back();
+        amount.pop_back();
+        rate.pop_back();
+        months.pop_back();
+    }
+
+    static DepositTable from(const std::vector<Deposit> &records)
+    {
+        DepositTable t;
+        t.reserve(records.size());
+        for (const auto &d : records)
+            t.push(d);
+        return t;
+    }
+
+    std::vector<Deposit> records() const
+    {
+        std::vector<Deposit> out(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            out[i] = row(i);
+        return out;
+    }
+};
+
 namespace Deposits
 {
     void showMenu();
     double calcSimple(const Deposit &d);
     double calcMaturity(const Deposit &d);
+
+    // column versions: out[i] is the result for row i
+    void calcSimple(const DepositTable &t, std::vector<double> &out);
+    void calcMaturity(const DepositTable &t, std::vector<double> &out);
     void displayAll(const std::vector<Deposit> &list);
 
 }
\ No newline at end of file
@@ -0,0 +1,417 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+
+#if defined(__AVX2__) && !defined(FINCALC_SCALAR_BITMAP)
+#include <immintrin.h>
+#define FINCALC_AVX2_BITMAP 1
+#else
+#define FINCALC_AVX2_BITMAP 0
+#endif
+
+// ---------------------------------------------------------
+// RoaringBitmap : compressed set of row numbers (Roaring layout).
+// Rows are split by their high 16 bits into containers of 65536.
+// A container with up to ARRAY_MAX rows is a sorted array of the low
+// 16 bits; a fuller one is a 65536-bit bitset (8 KB), so no container
+// takes more than 8 KB and sparse ones take 2 bytes a row. AND / OR of
+// two bitsets run 256 bits at a time with AVX2 (-DFINCALC_SCALAR_BITMAP
+// for the plain loop); arrays merge, or probe the other side's bits.
+// ---------------------------------------------------------
+class RoaringBitmap
+{
+public:
+    static constexpr std::size_t ARRAY_MAX = 4096;
+    static constexpr std::size_t WORDS = 1024; // 65536 bits
+
+private:
+    struct Container
+    {
+        std::uint16_t key = 0;
+        std::size_t count = 0;
+        std::vector<std::uint16_t> array; // when bits is empty
+        std::vector<std::uint64_t> bits;  // WORDS words once full
+
+        bool isBitset() const { return !bits.empty(); }
+        bool has(std::uint16_t low) const
+        {
+            if (isBitset())
+                return (bits[low >> 6] >> (low & 63)) & 1;
+            return std::binary_search(array.begin(), array.end(), low);
+        }
+    };
+
+    std::vector<Container> containers; // sorted by key
+
+    std::size_t slotFor(std::uint16_t key) const
+    {
+        std::size_t lo = 0, hi = containers.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (containers[mid].key < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    static void toBitset(Container &c)
+    {
+        c.bits.assign(WORDS, 0);
+        for (std::uint16_t low : c.array)
+            c.bits[low >> 6] |= std::uint64_t(1) << (low & 63);
+        c.array.clear();
+        c.array.shrink_to_fit();
+    }
+
+    static void toArray(Container &c)
+    {
+        c.array.clear();
+        c.array.reserve(c.count);
+        for (std::size_t w = 0; w < WORDS; ++w)
+            for (std::uint64_t word = c.bits[w]; word; word &= word - 1)
+                c.array.push_back(static_cast<std::uint16_t>(w * 64 + __builtin_ctzll(word)));
+        c.bits.clear();
+        c.bits.shrink_to_fit();
+    }
+
+    // bitset a op= bitset b, returning the new count
+    template <bool OR>
+    static std::size_t combineWords(std::uint64_t *a, const std::uint64_t *b)
+    {
+        static_assert(WORDS % 4 == 0, "bitset is a whole number of 256-bit lanes");
+#if FINCALC_AVX2_BITMAP
+        for (std::size_t w = 0; w < WORDS; w += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + w));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(a + w), OR ? _mm256_or_si256(x, y) : _mm256_and_si256(x, y));
+        }
+#else
+        for (std::size_t w = 0; w < WORDS; ++w)
+            a[w] = OR ? a[w] | b[w] : a[w] & b[w];
+#endif
+        std::size_t count = 0;
+        for (std::size_t w = 0; w < WORDS; ++w)
+            count += static_cast<std::size_t>(__builtin_popcountll(a[w]));
+        return count;
+    }
+
+    // a &= b for one pair of containers with the same key
+    static void intersect(Container &a, const Container &b)
+    {
+        if (a.isBitset() && b.isBitset())
+        {
+            a.count = combineWords<false>(a.bits.data(), b.bits.data());
+            if (a.count <= ARRAY_MAX)
+                toArray(a);
+            return;
+        }
+        if (a.isBitset())
+        {
+            // the array side is the result's upper bound
+            std::vector<std::uint16_t> kept;
+            kept.reserve(b.array.size());
+            for (std::uint16_t low : b.array)
+                if (a.has(low))
+                    kept.push_back(low);
+            a.bits.clear();
+            a.bits.shrink_to_fit();
+            a.array = std::move(kept);
+            a.count = a.array.size();
+            return;
+        }
+        std::size_t out = 0;
+        if (b.isBitset())
+        {
+            for (std::uint16_t low : a.array)
+                if (b.has(low))
+                    a.array[out++] = low;
+        }
+        else if (a.array.size() <= b.array.size())
+        {
+            // walk the shorter side, binary-searching the rest of the longer
+            auto it = b.array.begin();
+            for (std::uint16_t low : a.array)
+            {
+                it = std::lower_bound(it, b.array.end(), low);
+                if (it == b.array.end())
+                    break;
+                if (*it == low)
+                    a.array[out++] = low;
+            }
+        }
+        else
+        {
+            // same the other way round; a hit is never written past where
+            // the search in a has got to
+            auto it = a.array.begin();
+            for (std::uint16_t low : b.array)
+            {
+                it = std::lower_bound(it, a.array.end(), low);
+                if (it == a.array.end())
+                    break;
+                if (*it == low)
+                    a.array[out++] = low;
+            }
+        }
+        a.array.resize(out);
+        a.count = out;
+    }
+
+    // a |= b for one pair of containers with the same key
+    static void unite(Container &a, const Container &b)
+    {
+        if (!a.isBitset() && (b.isBitset() || a.count + b.count > ARRAY_MAX))
+            toBitset(a);
+        if (a.isBitset())
+        {
+            if (b.isBitset())
+                a.count = combineWords<true>(a.bits.data(), b.bits.data());
+            else
+            {
+                for (std::uint16_t low : b.array)
+                {
+                    std::uint64_t bit = std::uint64_t(1) << (low & 63);
+                    a.count += (a.bits[low >> 6] & bit) == 0;
+                    a.bits[low >> 6] |= bit;
+                }
+            }
+            return;
+        }
+        std::vector<std::uint16_t> merged;
+        merged.reserve(a.count + b.count);
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(merged));
+        a.array = std::move(merged);
+        a.count = a.array.size();
+    }
+
+public:
+    void add(std::uint32_t row)
+    {
+        std::uint16_t key = static_cast<std::uint16_t>(row >> 16), low = static_cast<std::uint16_t>(row);
+        std::size_t at = slotFor(key);
+        if (at == containers.size() || containers[at].key != key)
+        {
+            containers.insert(containers.begin() + at, Container());
+            containers[at].key = key;
+        }
+        Container &c = containers[at];
+        if (c.isBitset())
+        {
+            std::uint64_t bit = std::uint64_t(1) << (low & 63);
+            c.count += (c.bits[low >> 6] & bit) == 0;
+            c.bits[low >> 6] |= bit;
+            return;
+        }
+        // rows mostly arrive in order, so try the end first
+        if (c.array.empty() || c.array.back() < low)
+            c.array.push_back(low);
+        else
+        {
+            auto it = std::lower_bound(c.array.begin(), c.array.end(), low);
+            if (*it == low)
+                return;
+            c.array.insert(it, low);
+        }
+        if (++c.count > ARRAY_MAX)
+            toBitset(c);
+    }
+
+    bool remove(std::uint32_t row)
+    {
+        std::uint16_t key = static_cast<std::uint16_t>(row >> 16), low = static_cast<std::uint16_t>(row);
+        std::size_t at = slotFor(key);
+        if (at == containers.size() || containers[at].key != key || !containers[at].has(low))
+            return false;
+        Container &c = containers[at];
+        if (c.isBitset())
+        {
+            c.bits[low >> 6] &= ~(std::uint64_t(1) << (low & 63));
+            if (--c.count <= ARRAY_MAX)
+                toArray(c);
+        }
+        else
+        {
+            c.array.erase(std::lower_bound(c.array.begin(), c.array.end(), low));
+            --c.count;
+        }
+        if (c.count == 0)
+            containers.erase(containers.begin() + at);
+        return true;
+    }
+
+    bool contains(std::uint32_t row) const
+    {
+        std::uint16_t key = static_cast<std::uint16_t>(row >> 16);
+        std::size_t at = slotFor(key);
+        return at < containers.size() && containers[at].key == key && containers[at].has(static_cast<std::uint16_t>(row));
+    }
+
+    // this = this AND other
+    void andWith(const RoaringBitmap &other)
+    {
+        std::size_t out = 0, j = 0;
+        for (std::size_t i = 0; i < containers.size(); ++i)
+        {
+            while (j < other.containers.size() && other.containers[j].key < containers[i].key)
+                ++j;
+            if (j == other.containers.size())
+                break;
+            if (other.containers[j].key != containers[i].key)
+                continue;
+            intersect(containers[i], other.containers[j]);
+            if (containers[i].count != 0)
+            {
+                if (out != i)
+                    containers[out] = std::move(containers[i]);
+                ++out;
+            }
+        }
+        containers.resize(out);
+    }
+
+    // this = this OR other
+    void orWith(const RoaringBitmap &other)
+    {
+        std::vector<Container> merged;
+        merged.reserve(containers.size() + other.containers.size());
+        std::size_t i = 0, j = 0;
+        while (i < containers.size() || j < other.containers.size())
+        {
+            if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key))
+                merged.push_back(std::move(containers[i++]));
+            else if (i == containers.size() || other.containers[j].key < containers[i].key)
+                merged.push_back(other.containers[j++]);
+            else
+            {
+                unite(containers[i], other.containers[j++]);
+                merged.push_back(std::move(containers[i++]));
+            }
+        }
+        containers = std::move(merged);
+    }
+
+    std::size_t cardinality() const
+    {
+        std::size_t n = 0;
+        for (const Container &c : containers)
+            n += c.count;
+        return n;
+    }
+
+    bool empty() const { return containers.empty(); }
+    void clear() { containers.clear(); }
+
+    // every row, ascending
+    void rows(std::vector<std::size_t> &out) const
+    {
+        out.clear();
+        out.reserve(cardinality());
+        for (const Container &c : containers)
+        {
+            std::size_t high = std::size_t(c.key) << 16;
+            if (c.isBitset())
+            {
+                for (std::size_t w = 0; w < WORDS; ++w)
+                    for (std::uint64_t word = c.bits[w]; word; word &= word - 1)
+                        out.push_back(high | (w * 64 + __builtin_ctzll(word)));
+            }
+            else
+                for (std::uint16_t low : c.array)
+                    out.push_back(high | low);
+        }
+    }
+
+    // bytes held by the containers
+    std::size_t bytes() const
+    {
+        std::size_t n = containers.capacity() * sizeof(Container);
+        for (const Container &c : containers)
+            n += c.array.capacity() * sizeof(std::uint16_t) + c.bits.capacity() * sizeof(std::uint64_t);
+        return n;
+    }
+};
+
+// ---------------------------------------------------------
+// BitmapIndex<K> : one RoaringBitmap of rows per distinct value, for
+// fields with few distinct values (rates, tenures). The values are
+// kept sorted, so select(lo, hi) ORs the bitmaps of a whole range of
+// them. Same put / erase / replace / build as the other indexes.
+// ---------------------------------------------------------
+template <typename K>
+class BitmapIndex
+{
+    std::vector<K> values; // sorted, distinct
+    std::vector<RoaringBitmap> bitmaps;
+
+    std::size_t slotFor(const K &key) const
+    {
+        return static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), key) - values.begin());
+    }
+
+public:
+    // rows go in ascending, so every add appends
+    template <typename Data, typename KeyOf>
+    void build(const std::vector<Data> &data, KeyOf keyOf)
+    {
+        clear();
+        for (std::size_t row = 0; row < data.size(); ++row)
+            put(keyOf(data[row]), row);
+    }
+
+    void put(const K &key, std::size_t row)
+    {
+        std::size_t at = slotFor(key);
+        if (at == values.size() || key < values[at] || values[at] < key)
+        {
+            values.insert(values.begin() + at, key);
+            bitmaps.insert(bitmaps.begin() + at, RoaringBitmap());
+        }
+        bitmaps[at].add(static_cast<std::uint32_t>(row));
+    }
+
+    bool erase(const K &key, std::size_t row)
+    {
+        std::size_t at = slotFor(key);
+        if (at == values.size() || key < values[at] || values[at] < key)
+            return false;
+        if (!bitmaps[at].remove(static_cast<std::uint32_t>(row)))
+            return false;
+        if (bitmaps[at].empty())
+        {
+            values.erase(values.begin() + at);
+            bitmaps.erase(bitmaps.begin() + at);
+        }
+        return true;
+    }
+
+    bool replace(const K &key, std::size_t oldRow, std::size_t newRow)
+    {
+        if (!erase(key, oldRow))
+            return false;
+        put(key, newRow);
+        return true;
+    }
+
+    // out = rows with lo <= key <= hi
+    void select(const K &lo, const K &hi, RoaringBitmap &out) const
+    {
+        out.clear();
+        for (std::size_t at = slotFor(lo); at < values.size() && !(hi < values[at]); ++at)
+            out.orWith(bitmaps[at]);
+    }
+
+    std::size_t distinct() const { return values.size(); }
+
+    void clear()
+    {
+        values.clear();
+        bitmaps.clear();
+    }
+};
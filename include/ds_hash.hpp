@@ -4,100 +4,242 @@
 #include <type_traits>
 #include <functional>
 #include <utility>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#if defined(__SSE2__) && !defined(FINCALC_SCALAR_PROBE)
+#include <emmintrin.h>
+#define FINCALC_SSE2_PROBE 1
+#else
+#define FINCALC_SSE2_PROBE 0
+#endif
 
 // ---------------------------------------------------------
 // Single-value hash map: string -> index
-// now with load-factor check + rehash so it doesn't degrade
+// flat open addressing with linear probing. Every slot stores the
+// full hash, the value and where its key lives in one shared char
+// arena, so a miss only walks the slot array and a hit touches the
+// slot plus one run of key bytes. Rehash moves slots, never keys.
+// (the old chained version lives on in ds_hash_chained.hpp)
 // ---------------------------------------------------------
-struct StringIntMap
+class StringIntMap
 {
-    struct Node
+    struct Slot
     {
-        std::string key;
+        std::size_t hash; // 0 = empty
         std::size_t value;
+        std::uint32_t keyOff; // into arena
+        std::uint32_t keyLen;
     };
 
-    std::vector<std::vector<Node>> buckets;
-    std::size_t bucketCount;
+    std::vector<Slot> slots;
+    std::string arena; // all keys back to back
+    std::size_t deadBytes = 0; // arena bytes of erased keys
+    std::size_t mask;
     std::size_t size_; // number of pairs
 
-    explicit StringIntMap(std::size_t n = 101)
-        : bucketCount(n), size_(0)
+    static std::size_t roundUpPow2(std::size_t n)
     {
-        buckets.resize(bucketCount);
+        std::size_t cap = 8;
+        while (cap < n)
+            cap <<= 1;
+        return cap;
     }
 
-    std::size_t hash(const std::string &s) const
+    // never 0, so 0 can mark an empty slot
+    static std::size_t hashOf(const std::string &s)
     {
-        return std::hash<std::string>{}(s) % bucketCount;
+        return std::hash<std::string>{}(s) | 1;
     }
 
-    double loadFactor() const
+    bool keyEquals(const Slot &slot, const std::string &key) const
     {
-        return bucketCount == 0 ? 0.0
-                                : static_cast<double>(size_) / static_cast<double>(bucketCount);
+        return slot.keyLen == key.size() &&
+               arena.compare(slot.keyOff, slot.keyLen, key) == 0;
     }
 
-    void rehash(std::size_t newBucketCount)
+    // slot holding key, or the empty slot where it would go
+    std::size_t findSlot(const std::string &key, std::size_t h) const
     {
-        std::vector<std::vector<Node>> newBuckets;
-        newBuckets.resize(newBucketCount);
-
-        for (auto &bucket : buckets)
+        std::size_t i = h & mask;
+        while (slots[i].hash != 0)
         {
-            for (auto &node : bucket)
-            {
-                std::size_t idx = std::hash<std::string>{}(node.key) % newBucketCount;
-                newBuckets[idx].push_back(std::move(node));
-            }
+            if (slots[i].hash == h && keyEquals(slots[i], key))
+                return i;
+            i = (i + 1) & mask;
         }
+        return i;
+    }
+
+    void rehash(std::size_t newCapacity)
+    {
+        std::vector<Slot> old = std::move(slots);
+        slots.assign(newCapacity, Slot{0, 0, 0, 0});
+        mask = newCapacity - 1;
 
-        buckets = std::move(newBuckets);
-        bucketCount = newBucketCount;
+        for (const auto &slot : old)
+        {
+            if (slot.hash == 0)
+                continue;
+            std::size_t j = slot.hash & mask;
+            while (slots[j].hash != 0)
+                j = (j + 1) & mask;
+            slots[j] = slot;
+        }
     }
 
-    void maybeGrow()
+    // rewrite the arena with only the live keys
+    void compactArena()
     {
-        // keep it simple: grow when > 0.75
-        if (loadFactor() > 0.75)
+        std::string live;
+        live.reserve(arena.size() - deadBytes);
+        for (auto &slot : slots)
         {
-            rehash(bucketCount * 2 + 1);
+            if (slot.hash == 0)
+                continue;
+            std::uint32_t off = static_cast<std::uint32_t>(live.size());
+            live.append(arena, slot.keyOff, slot.keyLen);
+            slot.keyOff = off;
         }
+        arena.swap(live);
+        deadBytes = 0;
     }
 
-    void put(const std::string &key, std::size_t value)
+    void maybeGrow()
     {
-        std::size_t idx = hash(key);
-        auto &bucket = buckets[idx];
-        for (auto &node : bucket)
+        // linear probing degrades fast past half full
+        if (loadFactor() > 0.5)
+            rehash(slots.size() * 2);
+    }
+
+    // h must be hashOf(key)
+    void putHashed(const std::string &key, std::size_t h, std::size_t value)
+    {
+        std::size_t i = findSlot(key, h);
+        if (slots[i].hash != 0)
         {
-            if (node.key == key)
-            {
-                node.value = value;
-                return;
-            }
+            slots[i].value = value;
+            return;
         }
-        bucket.push_back({key, value});
+        slots[i] = Slot{h, value,
+                        static_cast<std::uint32_t>(arena.size()),
+                        static_cast<std::uint32_t>(key.size())};
+        arena += key;
         ++size_;
         maybeGrow();
     }
 
+public:
+    explicit StringIntMap(std::size_t n = 101)
+        : slots(roundUpPow2(n), Slot{0, 0, 0, 0}), mask(slots.size() - 1), size_(0)
+    {
+    }
+
+    double loadFactor() const
+    {
+        return static_cast<double>(size_) / static_cast<double>(slots.size());
+    }
+
+    // make room for n keys so the next n puts never rehash
+    void reserve(std::size_t n)
+    {
+        std::size_t needed = roundUpPow2(n * 2);
+        if (needed > slots.size())
+            rehash(needed);
+    }
+
+    // drop every pair, keep the capacity
+    void clear()
+    {
+        std::fill(slots.begin(), slots.end(), Slot{0, 0, 0, 0});
+        arena.clear();
+        deadBytes = 0;
+        size_ = 0;
+    }
+
+    // bulk load: key of the i-th element -> i, sized once up front.
+    // keyOf must return the name (by reference is cheapest).
+    template <typename It, typename KeyFn>
+    void build(It first, It last, KeyFn keyOf)
+    {
+        clear();
+        std::size_t n = 0;
+        std::size_t bytes = 0;
+        for (It it = first; it != last; ++it, ++n)
+            bytes += keyOf(*it).size();
+        reserve(n);
+        arena.reserve(bytes);
+
+        std::size_t i = 0;
+        for (It it = first; it != last; ++it, ++i)
+            put(keyOf(*it), i);
+    }
+
+    // same, with std::hash of every key already known (Storage::LoadInfo
+    // has them from the parsing threads) and keyBytes their total length,
+    // so nothing is counted or hashed again. Null hashes: plain build().
+    template <typename It, typename KeyFn>
+    void build(It first, It last, KeyFn keyOf, const std::size_t *hashes, std::size_t keyBytes)
+    {
+        if (!hashes)
+        {
+            build(first, last, keyOf);
+            return;
+        }
+        clear();
+        reserve(static_cast<std::size_t>(std::distance(first, last)));
+        arena.reserve(keyBytes);
+
+        std::size_t i = 0;
+        for (It it = first; it != last; ++it, ++i)
+            putHashed(keyOf(*it), hashes[i] | 1, i);
+    }
+
+    void put(const std::string &key, std::size_t value)
+    {
+        putHashed(key, hashOf(key), value);
+    }
+
+
     bool get(const std::string &key, std::size_t &out) const
     {
-        std::size_t idx = hash(key);
-        const auto &bucket = buckets[idx];
-        for (const auto &node : bucket)
+        std::size_t i = findSlot(key, hashOf(key));
+        if (slots[i].hash == 0)
+            return false;
+        out = slots[i].value;
+        return true;
+    }
+
+    // remove key; later members of its probe run shift back into the
+    // hole, so no tombstones are left behind
+    bool erase(const std::string &key)
+    {
+        std::size_t hole = findSlot(key, hashOf(key));
+        if (slots[hole].hash == 0)
+            return false;
+        deadBytes += slots[hole].keyLen;
+
+        for (std::size_t j = (hole + 1) & mask; slots[j].hash != 0; j = (j + 1) & mask)
         {
-            if (node.key == key)
+            std::size_t home = slots[j].hash & mask;
+            // j may move into the hole only if the hole lies on its probe path
+            if (((j - home) & mask) >= ((j - hole) & mask))
             {
-                out = node.value;
-                return true;
+                slots[hole] = slots[j];
+                hole = j;
             }
         }
-        return false;
+        slots[hole] = Slot{0, 0, 0, 0};
+        --size_;
+
+        if (deadBytes > 4096 && deadBytes * 2 > arena.size())
+            compactArena();
+        return true;
     }
 
-    std::size_t getBucketCount() const { return bucketCount; }
+    std::size_t getBucketCount() const { return slots.size(); }
     std::size_t size() const { return size_; }
 };
 
@@ -116,107 +258,454 @@ inline std::size_t genericHash<std::string>(const std::string &s)
     return std::hash<std::string>{}(s);
 }
 
+// ---------------------------------------------------------
+// IndexSpan : non-owning view over the indices stored for one key.
+// Valid until the next put / erase / replace / clear on the map it
+// came from.
+// ---------------------------------------------------------
+struct IndexSpan
+{
+    const std::size_t *first = nullptr;
+    std::size_t count = 0;
+
+    const std::size_t *begin() const { return first; }
+    const std::size_t *end() const { return first + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::size_t operator[](std::size_t i) const { return first[i]; }
+};
+
+// ---------------------------------------------------------
+// ProbeGroup : control-byte matching for the Swiss-style table.
+// 16 control bytes are compared at once; SSE2 on x86-64 (always
+// available there), a plain byte loop everywhere else. Build with
+// -DFINCALC_SCALAR_PROBE to force the portable path.
+// ---------------------------------------------------------
+namespace ProbeGroup
+{
+    constexpr std::size_t WIDTH = 16;
+    constexpr std::int8_t EMPTY = -128;  // 0b10000000
+    constexpr std::int8_t DELETED = -2;  // 0b11111110
+                                         // full slots hold 7 hash bits (0..127)
+
+    // bit i set when ctrl[i] == b
+    inline std::uint32_t match(const std::int8_t *ctrl, std::int8_t b)
+    {
+#if FINCALC_SSE2_PROBE
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(b), group)));
+#else
+        std::uint32_t bits = 0;
+        for (std::size_t i = 0; i < WIDTH; ++i)
+            bits |= static_cast<std::uint32_t>(ctrl[i] == b) << i;
+        return bits;
+#endif
+    }
+
+    // EMPTY and DELETED are the only negative control bytes
+    inline std::uint32_t matchFree(const std::int8_t *ctrl)
+    {
+#if FINCALC_SSE2_PROBE
+        return static_cast<std::uint32_t>(
+            _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl))));
+#else
+        std::uint32_t bits = 0;
+        for (std::size_t i = 0; i < WIDTH; ++i)
+            bits |= static_cast<std::uint32_t>(ctrl[i] < 0) << i;
+        return bits;
+#endif
+    }
+
+    inline int lowestBit(std::uint32_t bits) { return __builtin_ctz(bits); }
+}
+
+// spread the bits of cheap hashes (std::hash<int> is the identity)
+inline std::uint64_t mixHash(std::uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// numbers hash straight from their bits; anything else via genericHash
+template <typename K>
+inline std::uint64_t tableHash(const K &k)
+{
+    if constexpr (std::is_floating_point<K>::value)
+    {
+        double d = (k == 0) ? 0.0 : static_cast<double>(k); // -0.0 == 0.0
+        std::uint64_t bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        return mixHash(bits);
+    }
+    else if constexpr (std::is_integral<K>::value)
+        return mixHash(static_cast<std::uint64_t>(k));
+    else
+        return mixHash(genericHash<K>(k));
+}
+
 // ---------------------------------------------------------
 // HashMultiMap<K> : key -> vector<indices>
-// also with rehashing
+// Swiss-style open addressing: one control byte per slot (7 hash
+// bits, or EMPTY/DELETED) probed a 16-byte group at a time, and the
+// key + postings stored inline in the slot. A lookup is one control
+// group plus the matching slot. Rehash moves the postings vectors
+// (pointer swaps), never the indices inside them.
+// A key's postings are in no particular order, and a row is posted at
+// most once per key. Short lists are scanned to find a posting. A
+// list past SCAN gets a position table (row -> place in the list) on
+// its first erase / replace, so low-cardinality keys such as a rate
+// with 100k rows still erase and replace in O(1). The table holds
+// 32-bit rows and positions (rows fit in 32 bits, as in RoaringBitmap),
+// 2-4 slots per posting, and is dropped again once the list is back
+// under SCAN / 2.
+// (the old chained version lives on in ds_hash_chained.hpp)
 // ---------------------------------------------------------
 template <typename K>
 class HashMultiMap
 {
+    static constexpr std::size_t SCAN = 32;
+    static constexpr std::uint32_t NO_ROW = 0xFFFFFFFFu;
+
+    struct Where
+    {
+        std::uint32_t row; // NO_ROW = empty
+        std::uint32_t pos;
+    };
+
     struct Node
     {
         K key;
         std::vector<std::size_t> values;
+        std::vector<Where> where; // linear probing on row; empty until needed
     };
 
-    std::vector<std::vector<Node>> buckets;
-    std::size_t bucketCount;
-    std::size_t size_; // number of value insertions
+    std::vector<std::int8_t> ctrl;
+    std::vector<Node> slots;
+    std::size_t groupMask;  // group count - 1
+    std::size_t used;       // full slots (distinct keys)
+    std::size_t growthLeft; // free slots before we must grow
+    std::size_t size_;      // number of value insertions
+
+    static std::int8_t h2(std::uint64_t h) { return static_cast<std::int8_t>(h & 0x7F); }
+    static std::size_t h1(std::uint64_t h) { return static_cast<std::size_t>(h >> 7); }
+
+    std::size_t capacity() const { return slots.size(); }
 
-    std::size_t doHash(const K &k) const
+    // ----- per-key position table -----
+    static std::size_t whereSlot(const Node &n, std::size_t row)
     {
-        return genericHash<K>(k) % bucketCount;
+        std::size_t mask = n.where.size() - 1;
+        std::size_t i = mixHash(row) & mask;
+        while (n.where[i].row != NO_ROW && n.where[i].row != static_cast<std::uint32_t>(row))
+            i = (i + 1) & mask;
+        return i;
     }
 
-    void rehash(std::size_t newBucketCount)
+    static Where whereOf(std::size_t row, std::size_t pos)
     {
-        std::vector<std::vector<Node>> newBuckets;
-        newBuckets.resize(newBucketCount);
+        return Where{static_cast<std::uint32_t>(row), static_cast<std::uint32_t>(pos)};
+    }
+
+    // (re)build n.where from n.values: the smallest power of two of at
+    // least 2n slots, so between 1/4 and 1/2 full
+    static void indexPositions(Node &n)
+    {
+        std::size_t cap = 64;
+        while (cap < 2 * n.values.size())
+            cap <<= 1;
+        n.where.assign(cap, Where{NO_ROW, 0});
+        for (std::size_t i = 0; i < n.values.size(); ++i)
+            n.where[whereSlot(n, n.values[i])] = whereOf(n.values[i], i);
+    }
+
+    static void wherePut(Node &n, std::size_t row, std::size_t pos)
+    {
+        if (4 * n.values.size() > 3 * n.where.size())
+        {
+            indexPositions(n); // past 3/4 full; values already holds row
+            return;
+        }
+        n.where[whereSlot(n, row)] = whereOf(row, pos);
+    }
 
-        for (auto &bucket : buckets)
+    // backward-shift delete, as in StringIntMap::erase
+    static void whereErase(Node &n, std::size_t row)
+    {
+        std::size_t mask = n.where.size() - 1;
+        std::size_t hole = whereSlot(n, row);
+        for (std::size_t j = (hole + 1) & mask; n.where[j].row != NO_ROW; j = (j + 1) & mask)
         {
-            for (auto &node : bucket)
+            std::size_t home = mixHash(n.where[j].row) & mask;
+            if (((j - home) & mask) >= ((j - hole) & mask))
             {
-                std::size_t idx = genericHash<K>(node.key) % newBucketCount;
-                newBuckets[idx].push_back(std::move(node));
+                n.where[hole] = n.where[j];
+                hole = j;
             }
         }
+        n.where[hole] = Where{NO_ROW, 0};
+    }
 
-        buckets = std::move(newBuckets);
-        bucketCount = newBucketCount;
+    // place of row in n.values, or n.values.size() when absent
+    static std::size_t positionOf(Node &n, std::size_t row)
+    {
+        if (n.where.empty())
+        {
+            if (n.values.size() <= SCAN)
+                return static_cast<std::size_t>(std::find(n.values.begin(), n.values.end(), row) - n.values.begin());
+            indexPositions(n);
+        }
+        const Where &w = n.where[whereSlot(n, row)];
+        return w.row != NO_ROW ? w.pos : n.values.size();
     }
 
-    void maybeGrow()
+    // keep the table at most 7/8 full
+    static std::size_t maxLoad(std::size_t cap) { return cap - cap / 8; }
+
+    static std::size_t groupsFor(std::size_t n)
+    {
+        std::size_t groups = 1;
+        while (maxLoad(groups * ProbeGroup::WIDTH) < n)
+            groups <<= 1;
+        return groups;
+    }
+
+    // slot holding key, or capacity() when absent
+    std::size_t findSlot(const K &key, std::uint64_t h) const
+    {
+        std::int8_t tag = h2(h);
+        std::size_t g = h1(h) & groupMask;
+        for (std::size_t step = 1;; ++step)
+        {
+            const std::int8_t *group = ctrl.data() + g * ProbeGroup::WIDTH;
+            std::uint32_t hits = ProbeGroup::match(group, tag);
+            while (hits)
+            {
+                std::size_t slot = g * ProbeGroup::WIDTH + ProbeGroup::lowestBit(hits);
+                if (slots[slot].key == key)
+                    return slot;
+                hits &= hits - 1;
+            }
+            if (ProbeGroup::match(group, ProbeGroup::EMPTY))
+                return capacity();
+            g = (g + step) & groupMask; // triangular probing visits every group
+        }
+    }
+
+    // first EMPTY/DELETED slot on h's probe sequence
+    std::size_t findFreeSlot(std::uint64_t h) const
     {
-        double lf = bucketCount == 0 ? 0.0
-                                     : static_cast<double>(size_) / static_cast<double>(bucketCount);
-        if (lf > 0.75)
+        std::size_t g = h1(h) & groupMask;
+        for (std::size_t step = 1;; ++step)
         {
-            rehash(bucketCount * 2 + 1);
+            std::uint32_t free = ProbeGroup::matchFree(ctrl.data() + g * ProbeGroup::WIDTH);
+            if (free)
+                return g * ProbeGroup::WIDTH + ProbeGroup::lowestBit(free);
+            g = (g + step) & groupMask;
         }
     }
 
+    void resizeTable(std::size_t groups)
+    {
+        std::vector<std::int8_t> oldCtrl = std::move(ctrl);
+        std::vector<Node> oldSlots = std::move(slots);
+
+        ctrl.assign(groups * ProbeGroup::WIDTH, ProbeGroup::EMPTY);
+        slots.clear();
+        slots.resize(groups * ProbeGroup::WIDTH);
+        groupMask = groups - 1;
+
+        for (std::size_t i = 0; i < oldSlots.size(); ++i)
+        {
+            if (oldCtrl[i] < 0)
+                continue;
+            std::uint64_t h = tableHash(oldSlots[i].key);
+            std::size_t slot = findFreeSlot(h);
+            ctrl[slot] = h2(h);
+            slots[slot] = std::move(oldSlots[i]);
+        }
+        growthLeft = maxLoad(capacity()) - used;
+    }
+
+    // rough distinct-key count from a prefix sample, so a column with a
+    // handful of rates doesn't get a table sized for every record
+    template <typename It, typename KeyFn>
+    static std::size_t estimateKeys(It first, std::size_t n, KeyFn keyOf)
+    {
+        const std::size_t sample = std::min<std::size_t>(n, 1024);
+        if (sample == 0)
+            return 0;
+        std::vector<std::uint64_t> seen(2048, 0); // hashes | 1, 0 = empty
+        std::size_t distinct = 0;
+        It it = first;
+        for (std::size_t i = 0; i < sample; ++i, ++it)
+        {
+            std::uint64_t h = tableHash(keyOf(*it)) | 1;
+            std::size_t j = h & 2047;
+            while (seen[j] != 0 && seen[j] != h)
+                j = (j + 1) & 2047;
+            if (seen[j] == 0)
+            {
+                seen[j] = h;
+                ++distinct;
+            }
+        }
+        if (distinct * 2 <= sample)
+            return distinct * 2; // low cardinality: sample already saw most keys
+        return n / sample * distinct + distinct;
+    }
+
 public:
     explicit HashMultiMap(std::size_t n = 101)
-        : bucketCount(n), size_(0)
+        : groupMask(0), used(0), growthLeft(0), size_(0)
     {
-        buckets.resize(bucketCount);
+        resizeTable(groupsFor(n));
+    }
+
+    // make room for n distinct keys so inserting them never rehashes
+    void reserve(std::size_t n)
+    {
+        std::size_t groups = groupsFor(n);
+        if (groups > groupMask + 1)
+            resizeTable(groups);
+    }
+
+    // bulk load: the i-th element's key gets posting i. Equal keys are
+    // grouped in the same single pass; the table is sized once from a
+    // cardinality estimate (or expectedKeys when the caller knows it).
+    template <typename It, typename KeyFn>
+    void build(It first, It last, KeyFn keyOf, std::size_t expectedKeys = 0)
+    {
+        clear();
+        std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+        reserve(expectedKeys ? expectedKeys : estimateKeys(first, n, keyOf));
+
+        std::size_t i = 0;
+        for (It it = first; it != last; ++it, ++i)
+            put(keyOf(*it), i);
     }
 
     void put(const K &key, std::size_t valueIdx)
     {
-        std::size_t h = doHash(key);
-        auto &bucket = buckets[h];
-        for (auto &node : bucket)
+        std::uint64_t h = tableHash(key);
+        std::size_t slot = findSlot(key, h);
+        if (slot == capacity())
         {
-            if (node.key == key)
+            if (growthLeft == 0)
             {
-                node.values.push_back(valueIdx);
-                ++size_;
-                maybeGrow();
-                return;
+                // mostly tombstones? clean up in place instead of doubling
+                std::size_t groups = groupMask + 1;
+                resizeTable(used * 2 < maxLoad(capacity()) ? groups : groups * 2);
             }
+            slot = findFreeSlot(h);
+            if (ctrl[slot] == ProbeGroup::EMPTY)
+                --growthLeft;
+            ctrl[slot] = h2(h);
+            slots[slot].key = key;
+            slots[slot].values.clear();
+            slots[slot].where.clear();
+            ++used;
         }
-        Node nnode;
-        nnode.key = key;
-        nnode.values.push_back(valueIdx);
-        bucket.push_back(std::move(nnode));
+        Node &n = slots[slot];
+        n.values.push_back(valueIdx);
+        if (!n.where.empty())
+            wherePut(n, valueIdx, n.values.size() - 1);
         ++size_;
-        maybeGrow();
     }
 
+    // zero-copy lookup: empty span when the key is absent
+    IndexSpan get(const K &key) const
+    {
+        std::size_t slot = findSlot(key, tableHash(key));
+        if (slot == capacity())
+            return IndexSpan{};
+        const auto &values = slots[slot].values;
+        return IndexSpan{values.data(), values.size()};
+    }
+
+    // copying lookup, kept for callers that need to own the result
     bool get(const K &key, std::vector<std::size_t> &out) const
     {
-        std::size_t h = doHash(key);
-        const auto &bucket = buckets[h];
-        for (const auto &node : bucket)
+        IndexSpan found = get(key);
+        if (found.empty())
+            return false;
+        out.assign(found.begin(), found.end());
+        return true;
+    }
+
+    // drop one posting; the key's last posting takes its place. A key
+    // whose last posting goes becomes a DELETED slot.
+    bool erase(const K &key, std::size_t valueIdx)
+    {
+        std::size_t slot = findSlot(key, tableHash(key));
+        if (slot == capacity())
+            return false;
+        Node &n = slots[slot];
+        std::size_t at = positionOf(n, valueIdx);
+        if (at == n.values.size())
+            return false;
+        std::size_t moved = n.values.back();
+        n.values[at] = moved;
+        n.values.pop_back();
+        --size_;
+        if (n.values.empty())
         {
-            if (node.key == key)
-            {
-                out = node.values;
-                return true;
-            }
+            ctrl[slot] = ProbeGroup::DELETED;
+            --used;
+        }
+        if (n.values.size() <= SCAN / 2)
+        {
+            if (!n.where.empty())
+                std::vector<Where>().swap(n.where); // short again: scan it
+        }
+        else if (!n.where.empty())
+        {
+            whereErase(n, valueIdx);
+            if (moved != valueIdx)
+                n.where[whereSlot(n, moved)].pos = static_cast<std::uint32_t>(at);
         }
-        return false;
+        return true;
+    }
+
+    // rename one posting in place (record moved from oldIdx to newIdx)
+    bool replace(const K &key, std::size_t oldIdx, std::size_t newIdx)
+    {
+        std::size_t slot = findSlot(key, tableHash(key));
+        if (slot == capacity())
+            return false;
+        Node &n = slots[slot];
+        std::size_t at = positionOf(n, oldIdx);
+        if (at == n.values.size())
+            return false;
+        n.values[at] = newIdx;
+        if (!n.where.empty())
+        {
+            whereErase(n, oldIdx);
+            n.where[whereSlot(n, newIdx)] = whereOf(newIdx, at);
+        }
+        return true;
     }
 
     void clear()
     {
-        for (auto &b : buckets)
-            b.clear();
+        for (std::size_t i = 0; i < capacity(); ++i)
+        {
+            if (ctrl[i] >= 0)
+            {
+                slots[i].values.clear();
+                slots[i].where.clear();
+            }
+        }
+        std::fill(ctrl.begin(), ctrl.end(), ProbeGroup::EMPTY);
+        used = 0;
+        growthLeft = maxLoad(capacity());
         size_ = 0;
     }
 
-    std::size_t getBucketCount() const { return bucketCount; }
+    std::size_t getBucketCount() const { return capacity(); }
     std::size_t size() const { return size_; }
 };
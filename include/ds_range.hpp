@@ -0,0 +1,226 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+#include "ds_hash.hpp"
+#include "utilities.hpp"
+
+// ---------------------------------------------------------
+// RangeIndex<K> : ordered secondary index for "between" queries.
+// (key, row) postings sorted by key, then row, and cut into blocks
+// of at most 2 * BLOCK postings; every block keeps its keys and rows
+// in two arrays, and the index keeps each block's last posting as a
+// fence. A lookup binary-searches the fences, then one block, so
+// range() is O(log n + k) and hands back the rows of each block it
+// touched as an IndexSpan, without copying them. put / erase touch
+// one block: a full block splits in two, an empty one is dropped.
+// ---------------------------------------------------------
+template <typename K>
+class RangeIndex
+{
+    static constexpr std::size_t BLOCK = 256;
+
+    struct Block
+    {
+        std::vector<K> keys;
+        std::vector<std::size_t> rows;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<K> fenceKey; // last posting of blocks[b]
+    std::vector<std::size_t> fenceRow;
+    std::size_t size_ = 0;
+
+    static bool before(const K &ak, std::size_t ar, const K &bk, std::size_t br)
+    {
+        return ak < bk || (!(bk < ak) && ar < br);
+    }
+
+    // first block whose last posting is not before (key, row)
+    std::size_t blockFor(const K &key, std::size_t row) const
+    {
+        std::size_t lo = 0, hi = blocks.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (before(fenceKey[mid], fenceRow[mid], key, row))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // first position in b not before (key, row)
+    static std::size_t positionIn(const Block &b, const K &key, std::size_t row)
+    {
+        std::size_t lo = 0, hi = b.keys.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (before(b.keys[mid], b.rows[mid], key, row))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    void refence(std::size_t b)
+    {
+        fenceKey[b] = blocks[b].keys.back();
+        fenceRow[b] = blocks[b].rows.back();
+    }
+
+    void split(std::size_t b)
+    {
+        Block upper;
+        std::size_t half = blocks[b].keys.size() / 2;
+        upper.keys.assign(blocks[b].keys.begin() + half, blocks[b].keys.end());
+        upper.rows.assign(blocks[b].rows.begin() + half, blocks[b].rows.end());
+        blocks[b].keys.resize(half);
+        blocks[b].rows.resize(half);
+        blocks.insert(blocks.begin() + b + 1, std::move(upper));
+        fenceKey.insert(fenceKey.begin() + b + 1, K());
+        fenceRow.insert(fenceRow.begin() + b + 1, 0);
+        refence(b);
+        refence(b + 1);
+    }
+
+    void appendBlock()
+    {
+        blocks.emplace_back();
+        blocks.back().keys.reserve(BLOCK);
+        blocks.back().rows.reserve(BLOCK);
+        fenceKey.emplace_back();
+        fenceRow.emplace_back();
+    }
+
+public:
+    // bulk load: one radix sort of the rows by key (stable, so equal
+    // keys stay in row order), then full blocks of BLOCK postings
+    template <typename Data, typename KeyOf>
+    void build(const std::vector<Data> &data, KeyOf keyOf)
+    {
+        clear();
+        std::vector<std::size_t> order(data.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        if (!order.empty())
+            Utilities::radixSortIndices(order, data, keyOf);
+
+        blocks.reserve(order.size() / BLOCK + 1);
+        for (std::size_t row : order)
+        {
+            if (blocks.empty() || blocks.back().keys.size() == BLOCK)
+                appendBlock();
+            blocks.back().keys.push_back(keyOf(data[row]));
+            blocks.back().rows.push_back(row);
+        }
+        for (std::size_t b = 0; b < blocks.size(); ++b)
+            refence(b);
+        size_ = order.size();
+    }
+
+    void put(const K &key, std::size_t row)
+    {
+        if (blocks.empty())
+            appendBlock();
+        std::size_t b = blockFor(key, row);
+        if (b == blocks.size())
+            --b; // past every fence: goes at the end of the last block
+        Block &block = blocks[b];
+        std::size_t at = positionIn(block, key, row);
+        block.keys.insert(block.keys.begin() + at, key);
+        block.rows.insert(block.rows.begin() + at, row);
+        ++size_;
+        if (block.keys.size() == 2 * BLOCK)
+            split(b);
+        else
+            refence(b);
+    }
+
+    bool erase(const K &key, std::size_t row)
+    {
+        std::size_t b = blockFor(key, row);
+        if (b == blocks.size())
+            return false;
+        Block &block = blocks[b];
+        std::size_t at = positionIn(block, key, row);
+        if (at == block.keys.size() || block.rows[at] != row || block.keys[at] < key || key < block.keys[at])
+            return false;
+        block.keys.erase(block.keys.begin() + at);
+        block.rows.erase(block.rows.begin() + at);
+        --size_;
+        if (block.keys.empty())
+        {
+            blocks.erase(blocks.begin() + b);
+            fenceKey.erase(fenceKey.begin() + b);
+            fenceRow.erase(fenceRow.begin() + b);
+        }
+        else
+            refence(b);
+        return true;
+    }
+
+    // rename one posting (record moved from oldRow to newRow); rows
+    // order equal keys, so it may change place
+    bool replace(const K &key, std::size_t oldRow, std::size_t newRow)
+    {
+        if (!erase(key, oldRow))
+            return false;
+        put(key, newRow);
+        return true;
+    }
+
+    // rows with lo <= key <= hi in key order, one span per block
+    // touched; valid until the next put / erase / build / clear
+    void range(const K &lo, const K &hi, std::vector<IndexSpan> &out) const
+    {
+        out.clear();
+        if (hi < lo)
+            return;
+        std::size_t b = blockFor(lo, 0);
+        for (; b < blocks.size(); ++b)
+        {
+            const Block &block = blocks[b];
+            std::size_t first = out.empty() ? positionIn(block, lo, 0) : 0;
+            std::size_t last = block.keys.size();
+            bool done = hi < fenceKey[b];
+            if (done)
+                last = std::upper_bound(block.keys.begin() + first, block.keys.end(), hi) - block.keys.begin();
+            if (last > first)
+                out.push_back(IndexSpan{block.rows.data() + first, last - first});
+            if (done)
+                break;
+        }
+    }
+
+    // how many rows range(lo, hi) would give
+    std::size_t count(const K &lo, const K &hi) const
+    {
+        std::vector<IndexSpan> spans;
+        range(lo, hi, spans);
+        std::size_t n = 0;
+        for (const IndexSpan &s : spans)
+            n += s.size();
+        return n;
+    }
+
+    void clear()
+    {
+        blocks.clear();
+        fenceKey.clear();
+        fenceRow.clear();
+        size_ = 0;
+    }
+
+    // smallest / largest key, O(1); only when size() > 0
+    const K &minKey() const { return blocks.front().keys.front(); }
+    const K &maxKey() const { return fenceKey.back(); }
+
+    std::size_t size() const { return size_; }
+    std::size_t blockCount() const { return blocks.size(); }
+};
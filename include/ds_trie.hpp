@@ -0,0 +1,387 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "ds_hash.hpp"
+
+// ---------------------------------------------------------
+// RadixTree : compressed trie over names -> rows.
+// Every edge carries a run of characters and every node has at least
+// two children or some rows of its own, so the tree has fewer nodes
+// than there are names. Children are kept sorted by first byte, which
+// makes a subtree walk come out in name order. Nodes live in one
+// vector; freed ones are reused.
+// ---------------------------------------------------------
+class RadixTree
+{
+    struct Node
+    {
+        std::string label;                  // the edge into this node
+        std::vector<std::uint32_t> children; // sorted by label[0]
+        std::vector<std::size_t> rows;      // names that end here
+    };
+
+    std::vector<Node> nodes; // [0] is the root
+    std::vector<std::uint32_t> freed;
+    std::size_t size_ = 0;
+
+    static unsigned char byte(char c) { return static_cast<unsigned char>(c); }
+
+    std::uint32_t newNode()
+    {
+        if (!freed.empty())
+        {
+            std::uint32_t n = freed.back();
+            freed.pop_back();
+            return n;
+        }
+        nodes.emplace_back();
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    void freeNode(std::uint32_t n)
+    {
+        nodes[n].label.clear();
+        nodes[n].children.clear();
+        nodes[n].rows.clear();
+        freed.push_back(n);
+    }
+
+    // position in node's children of the child starting with c (or where it would go)
+    std::size_t childSlot(std::uint32_t node, unsigned char c) const
+    {
+        const auto &kids = nodes[node].children;
+        std::size_t lo = 0, hi = kids.size();
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (byte(nodes[kids[mid]].label[0]) < c)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // child of node starting with c, or 0 (the root is never a child)
+    std::uint32_t child(std::uint32_t node, unsigned char c) const
+    {
+        std::size_t at = childSlot(node, c);
+        const auto &kids = nodes[node].children;
+        return at < kids.size() && byte(nodes[kids[at]].label[0]) == c ? kids[at] : 0;
+    }
+
+    void addChild(std::uint32_t node, std::uint32_t kid)
+    {
+        std::size_t at = childSlot(node, byte(nodes[kid].label[0]));
+        nodes[node].children.insert(nodes[node].children.begin() + at, kid);
+    }
+
+    // node for exactly this name, or 0; path gets every node on the way
+    std::uint32_t find(const std::string &name, std::vector<std::uint32_t> *path) const
+    {
+        std::uint32_t node = 0;
+        std::size_t pos = 0;
+        while (pos < name.size())
+        {
+            std::uint32_t next = child(node, byte(name[pos]));
+            if (next == 0)
+                return 0;
+            const std::string &label = nodes[next].label;
+            if (name.compare(pos, label.size(), label) != 0)
+                return 0;
+            if (path)
+                path->push_back(node);
+            pos += label.size();
+            node = next;
+        }
+        return pos == name.size() && (node != 0 || name.empty()) ? node : 0;
+    }
+
+    // a node left with no rows and one child folds the child into itself
+    void mergeWithOnlyChild(std::uint32_t node)
+    {
+        Node &n = nodes[node];
+        if (node == 0 || !n.rows.empty() || n.children.size() != 1)
+            return;
+        std::uint32_t kid = n.children[0];
+        n.label += nodes[kid].label;
+        n.children = std::move(nodes[kid].children);
+        n.rows = std::move(nodes[kid].rows);
+        freeNode(kid);
+    }
+
+    void collect(std::uint32_t node, std::vector<std::size_t> &out) const
+    {
+        const Node &n = nodes[node];
+        out.insert(out.end(), n.rows.begin(), n.rows.end());
+        for (std::uint32_t kid : n.children)
+            collect(kid, out);
+    }
+
+    // names[order[lo..hi)] are sorted and share their first depth bytes,
+    // which node already spells out
+    template <typename Data, typename NameOf>
+    void buildSorted(std::uint32_t node, const std::vector<Data> &data, const std::vector<std::size_t> &order,
+                     std::size_t lo, std::size_t hi, std::size_t depth, NameOf nameOf)
+    {
+        while (lo < hi && nameOf(data[order[lo]]).size() == depth)
+            nodes[node].rows.push_back(order[lo++]);
+        while (lo < hi)
+        {
+            const std::string &first = nameOf(data[order[lo]]);
+            unsigned char c = byte(first[depth]);
+            std::size_t end = lo + 1;
+            while (end < hi && byte(nameOf(data[order[end]])[depth]) == c)
+                ++end;
+
+            // sorted, so the group shares what its first and last share
+            const std::string &last = nameOf(data[order[end - 1]]);
+            std::size_t common = depth + 1;
+            while (common < first.size() && common < last.size() && first[common] == last[common])
+                ++common;
+
+            std::uint32_t kid = newNode(); // may move nodes: no references across it
+            nodes[kid].label = first.substr(depth, common - depth);
+            nodes[node].children.push_back(kid);
+            buildSorted(kid, data, order, lo, end, common, nameOf);
+            lo = end;
+        }
+    }
+
+public:
+    RadixTree() { clear(); }
+
+    // bulk load from rows already sorted by name (the rebuilt view)
+    template <typename Data, typename NameOf>
+    void build(const std::vector<Data> &data, const std::vector<std::size_t> &byName, NameOf nameOf)
+    {
+        clear();
+        buildSorted(0, data, byName, 0, byName.size(), 0, nameOf);
+        size_ = byName.size();
+    }
+
+    void put(const std::string &name, std::size_t row)
+    {
+        std::uint32_t node = 0;
+        std::size_t pos = 0;
+        while (pos < name.size())
+        {
+            std::uint32_t next = child(node, byte(name[pos]));
+            if (next == 0)
+            {
+                std::uint32_t leaf = newNode();
+                nodes[leaf].label = name.substr(pos);
+                nodes[leaf].rows.push_back(row);
+                addChild(node, leaf);
+                ++size_;
+                return;
+            }
+            std::size_t common = 0;
+            const std::string &label = nodes[next].label;
+            while (common < label.size() && pos + common < name.size() && label[common] == name[pos + common])
+                ++common;
+            if (common < label.size())
+            {
+                // split the edge: node -> mid -> next
+                std::size_t at = childSlot(node, byte(name[pos]));
+                std::uint32_t mid = newNode();
+                nodes[mid].label = nodes[next].label.substr(0, common);
+                nodes[next].label.erase(0, common);
+                nodes[mid].children.push_back(next);
+                nodes[node].children[at] = mid;
+                next = mid;
+            }
+            node = next;
+            pos += common;
+        }
+        nodes[node].rows.push_back(row);
+        ++size_;
+    }
+
+    bool erase(const std::string &name, std::size_t row)
+    {
+        std::vector<std::uint32_t> path;
+        std::uint32_t node = find(name, &path);
+        if (node == 0 && !name.empty())
+            return false;
+        auto &rows = nodes[node].rows;
+        auto it = std::find(rows.begin(), rows.end(), row);
+        if (it == rows.end())
+            return false;
+        rows.erase(it);
+        --size_;
+
+        if (node != 0 && rows.empty() && nodes[node].children.empty())
+        {
+            std::uint32_t parent = path.back();
+            auto &kids = nodes[parent].children;
+            kids.erase(kids.begin() + childSlot(parent, byte(nodes[node].label[0])));
+            freeNode(node);
+            mergeWithOnlyChild(parent);
+        }
+        else
+            mergeWithOnlyChild(node);
+        return true;
+    }
+
+    // rename one posting in place (record moved from oldRow to newRow)
+    bool replace(const std::string &name, std::size_t oldRow, std::size_t newRow)
+    {
+        std::uint32_t node = find(name, nullptr);
+        if (node == 0 && !name.empty())
+            return false;
+        for (auto &r : nodes[node].rows)
+        {
+            if (r == oldRow)
+            {
+                r = newRow;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // rows of exactly this name; valid until the next put / erase / clear
+    IndexSpan rowsOf(const std::string &name) const
+    {
+        std::uint32_t node = find(name, nullptr);
+        if (node == 0 && !name.empty())
+            return IndexSpan{};
+        const auto &rows = nodes[node].rows;
+        return IndexSpan{rows.data(), rows.size()};
+    }
+
+    // rows of every name starting with prefix, in name order:
+    // O(|prefix|) to find the subtree, then O(k) to walk it
+    void withPrefix(const std::string &prefix, std::vector<std::size_t> &out) const
+    {
+        out.clear();
+        std::uint32_t node = 0;
+        std::size_t pos = 0;
+        while (pos < prefix.size())
+        {
+            node = child(node, byte(prefix[pos]));
+            if (node == 0)
+                return;
+            const std::string &label = nodes[node].label;
+            std::size_t n = std::min(label.size(), prefix.size() - pos);
+            if (label.compare(0, n, prefix, pos, n) != 0)
+                return;
+            pos += n;
+        }
+        collect(node, out);
+    }
+
+    void clear()
+    {
+        nodes.assign(1, Node());
+        freed.clear();
+        size_ = 0;
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t nodeCount() const { return nodes.size() - freed.size(); }
+};
+
+// ---------------------------------------------------------
+// TrigramIndex : every 3-byte window of a name -> rows, for
+// "name contains" searches. A query looks up each of its trigrams,
+// takes the shortest posting list and checks only those names, so
+// it reads a few postings instead of every name. Queries shorter
+// than a trigram have no such list and scan the names.
+// ---------------------------------------------------------
+class TrigramIndex
+{
+    HashMultiMap<std::uint32_t> grams;
+
+    static std::uint32_t gram(const std::string &s, std::size_t i)
+    {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(s[i])) << 16 |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(s[i + 1])) << 8 |
+               static_cast<unsigned char>(s[i + 2]);
+    }
+
+    // each distinct trigram of s once, so a row is posted once per trigram
+    static void distinctGrams(const std::string &s, std::vector<std::uint32_t> &out)
+    {
+        out.clear();
+        for (std::size_t i = 0; i + 3 <= s.size(); ++i)
+            out.push_back(gram(s, i));
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+public:
+    TrigramIndex() : grams(4099) {}
+
+    template <typename Data, typename NameOf>
+    void build(const std::vector<Data> &data, NameOf nameOf)
+    {
+        grams.clear();
+        grams.reserve(data.size() < 8192 ? 4 * data.size() : 32768);
+        std::vector<std::uint32_t> g;
+        for (std::size_t row = 0; row < data.size(); ++row)
+        {
+            distinctGrams(nameOf(data[row]), g);
+            for (std::uint32_t k : g)
+                grams.put(k, row);
+        }
+    }
+
+    void put(const std::string &name, std::size_t row)
+    {
+        std::vector<std::uint32_t> g;
+        distinctGrams(name, g);
+        for (std::uint32_t k : g)
+            grams.put(k, row);
+    }
+
+    void erase(const std::string &name, std::size_t row)
+    {
+        std::vector<std::uint32_t> g;
+        distinctGrams(name, g);
+        for (std::uint32_t k : g)
+            grams.erase(k, row);
+    }
+
+    void replace(const std::string &name, std::size_t oldRow, std::size_t newRow)
+    {
+        std::vector<std::uint32_t> g;
+        distinctGrams(name, g);
+        for (std::uint32_t k : g)
+            grams.replace(k, oldRow, newRow);
+    }
+
+    // rows whose name contains part
+    template <typename Data, typename NameOf>
+    void withSubstring(const std::string &part, const std::vector<Data> &data, NameOf nameOf,
+                       std::vector<std::size_t> &out) const
+    {
+        out.clear();
+        if (part.size() < 3)
+        {
+            for (std::size_t row = 0; row < data.size(); ++row)
+                if (nameOf(data[row]).find(part) != std::string::npos)
+                    out.push_back(row);
+            return;
+        }
+
+        IndexSpan shortest;
+        for (std::size_t i = 0; i + 3 <= part.size(); ++i)
+        {
+            IndexSpan rows = grams.get(gram(part, i));
+            if (rows.empty())
+                return;
+            if (i == 0 || rows.size() < shortest.size())
+                shortest = rows;
+        }
+        for (std::size_t row : shortest)
+            if (part.size() == 3 || nameOf(data[row]).find(part) != std::string::npos)
+                out.push_back(row);
+    }
+
+    void clear() { grams.clear(); }
+};
@@ -1,6 +1,10 @@
 #pragma once
 #include <vector>
+#include <utility>
 #include <string>
+#include <iosfwd>
+
+class ThreadPool;
 
 struct Loan
 {
@@ -28,11 +32,162 @@ namespace LoanBy
     inline bool byYears(const Loan &a, const Loan &b) { return a.years < b.years; }
 }
 
+// columnar (struct-of-arrays) copy of a loan book: one contiguous
+// vector per field, so a scan over one numeric field doesn't drag the
+// names through the cache. Row i of every column is record i.
+struct LoanTable
+{
+    std::vector<std::string> name;
+    std::vector<double> principal;
+    std::vector<double> rate;
+    std::vector<int> years;
+
+    std::size_t size() const { return name.size(); }
+    bool empty() const { return name.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        name.reserve(n);
+        principal.reserve(n);
+        rate.reserve(n);
+        years.reserve(n);
+    }
+
+    void clear()
+    {
+        name.clear();
+        principal.clear();
+        rate.clear();
+        years.clear();
+    }
+
+    void push(const Loan &l)
+    {
+        name.push_back(l.name);
+        principal.push_back(l.principal);
+        rate.push_back(l.rate);
+        years.push_back(l.years);
+    }
+
+    Loan row(std::size_t i) const
+    {
+        Loan l;
+        l.name = name[i];
+        l.principal = principal[i];
+        l.rate = rate[i];
+        l.years = years[i];
+        return l;
+    }
+
+    void set(std::size_t i, const Loan &l)
+    {
+        name[i] = l.name;
+        principal[i] = l.principal;
+        rate[i] = l.rate;
+        years[i] = l.years;
+    }
+
+    // swap-and-pop, same as the menus do on the record vector
+    void removeAt(std::size_t i)
+    {
+        name[i] = std::move(name.back());
+        principal[i] = std::move(principal.back());
+        rate[i] = std::move(rate.back());
+        years[i] = std::move(years.back());
+        name.pop_back();
+        principal.pop_back();
+        rate.pop_back();
+        years.pop_back();
+    }
+
+    static LoanTable from(const std::vector<Loan> &records)
+    {
+        LoanTable t;
+        t.reserve(records.size());
+        for (const auto &l : records)
+            t.push(l);
+        return t;
+    }
+
+    std::vector<Loan> records() const
+    {
+        std::vector<Loan> out(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            out[i] = row(i);
+        return out;
+    }
+};
+
+// one month of an amortization schedule
+struct ScheduleRow
+{
+    std::size_t loan; // row of the table it belongs to
+    int month;        // 1-based
+    double payment;
+    double interest;
+    double principal;
+    double balance; // still owed after this payment
+};
+
 namespace Loans
 {
     void showMenu();
     double calcSimple(const Loan &loan);
     double calcCompound(const Loan &loan);
     double calcEMI(const Loan &loan);
+
+    // column versions: out[i] is the result for row i
+    void calcSimple(const LoanTable &t, std::vector<double> &out);
+    void calcCompound(const LoanTable &t, std::vector<double> &out);
+    void calcEMI(const LoanTable &t, std::vector<double> &out);
+
+    // the same over plain arrays of n loans, for repricing whole
+    // portfolios. The growth factor is within 1 ULP of std::pow; the
+    // closing formula magnifies that by about g / (g - 1), so against
+    // the scalar functions (2M loans, 1-50 years) compound / EMI stay
+    // within 7 / 14 ULP at rates >= 10 %, 22 / 41 at 2-10 %, 38 / 214 at
+    // 0.5-2 % and 172 / 359 below: under 1e-13 relative throughout.
+    void calcCompound(const double *principal, const double *rate, const int *years,
+                      std::size_t n, double *out);
+    void calcEMI(const double *principal, const double *rate, const int *years,
+                 std::size_t n, double *out);
     void displayAll(const std::vector<Loan> &loans);
+
+    // ----- amortization schedules -----
+    // Month by month at the calcEMI payment: interest on the balance,
+    // the rest pays principal, and the last month settles what the
+    // rounding left over (a 0 % loan pays principal / months).
+    // Loans are split across the pool in pieces of about
+    // SCHEDULE_PIECE_ROWS rows; nothing is allocated per row.
+    constexpr std::size_t SCHEDULE_PIECE_ROWS = 1 << 15;
+
+    // months in a schedule: years * 12, none for a term <= 0
+    std::size_t scheduleLength(int years);
+    // one loan's schedule into out[0, scheduleLength(years))
+    void schedule(std::size_t loan, double principal, double rate, int years, ScheduleRow *out);
+    // rows in the schedules of loans [first, last) of t
+    std::size_t scheduleRows(const LoanTable &t, std::size_t first, std::size_t last);
+    // those schedules back to back into out, which holds scheduleRows() rows
+    void schedules(const LoanTable &t, std::size_t first, std::size_t last, ScheduleRow *out,
+                   ThreadPool &pool);
+
+    // Streams schedules as CSV (name,month,payment,interest,principal,
+    // balance; header first): pieces are formatted in parallel into
+    // buffers kept between calls and written in loan order, one write
+    // each, so memory stays at a couple of pieces per thread.
+    class ScheduleWriter
+    {
+    public:
+        ScheduleWriter(std::ostream &out, ThreadPool &pool);
+
+        // every loan of t; false once a write has failed
+        bool write(const LoanTable &t);
+        std::size_t rows() const { return rows_; }
+
+    private:
+        std::ostream &out_;
+        ThreadPool &pool_;
+        std::vector<std::string> pieces_;
+        std::size_t rows_ = 0;
+    };
 }
@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "loans.hpp"
+#include "deposits.hpp"
+
+class ThreadPool;
+
+// a short-rate model, stepped monthly. Rates are in percent a year
+// like the books (7.5 = 7.5 %):
+//   Vasicek: dr = speed * (level - r) dt + vol dW
+//   CIR:     dr = speed * (level - r) dt + vol * sqrt(r) dW
+// CIR uses full truncation (max(r, 0) in the drift, the diffusion and
+// every rate read off the path), so its vol is per sqrt(percent).
+struct RateModel
+{
+    enum Kind
+    {
+        Vasicek,
+        CIR
+    };
+    Kind kind = Vasicek;
+    double start = 7.0; // r at month 0
+    double level = 7.0; // long-run mean
+    double speed = 0.2; // pull towards level, per year
+    double vol = 1.0;   // per sqrt(year)
+};
+
+// the book along one rate path. A loan pays its calcEMI payment for
+// its term and is valued as those payments discounted at the path's
+// rate; a deposit floats, earning its own rate plus the path's move
+// away from start each month, simple interest as in calcMaturity.
+struct PathValue
+{
+    double loanValue = 0;       // present value of every EMI stream
+    double depositMaturity = 0; // what the deposits pay out at maturity
+    double depositValue = 0;    // those payouts discounted to today
+};
+
+// one field of PathValue over all paths
+struct PathStats
+{
+    double mean = 0;
+    double stddev = 0;
+    double p5 = 0; // 5th percentile
+    double p50 = 0;
+    double p95 = 0;
+};
+
+// ---------------------------------------------------------
+// Monte Carlo over rate paths.
+// Every number a path draws comes from a Philox4x32-10 counter keyed
+// by (seed, path, month), so path p is the same path whatever thread
+// runs it and however many there are. Paths are stepped BLOCK_PATHS
+// at a time as plain arrays (one loop per stage, which the compiler
+// vectorises), and runs of PATHS_PER_TASK paths go to the pool.
+// The book enters only through Book: the value of a path is linear in
+// the records once they are summed by term, so the cost per path is
+// one pass over the months, not over the records.
+// ---------------------------------------------------------
+namespace MonteCarlo
+{
+    constexpr std::size_t BLOCK_PATHS = 64;
+    constexpr std::size_t PATHS_PER_TASK = 4096;
+
+    // the records summed by term; index m is an m-month term, and
+    // records with a term <= 0 are left out
+    struct Book
+    {
+        std::vector<double> loanEmi;       // sum of calcEMI payments
+        std::vector<double> depositAmount; // sum of amounts
+        std::vector<double> depositFixed;  // sum of calcMaturity at the booked rate
+        int months = 0;                    // longest term, the length of every path
+
+        static Book from(const LoanTable &loans, const DepositTable &deposits);
+    };
+
+    // rate[t] for month t (rate[0] = start) of one path, t <= months
+    void path(const RateModel &model, std::uint64_t seed, std::uint64_t p, int months, double *rate);
+
+    // out[i] is path first + i
+    void simulate(const Book &book, const RateModel &model, std::uint64_t seed,
+                  std::uint64_t first, std::size_t paths, PathValue *out, ThreadPool &pool);
+
+    // one record at a time along a path from path(); the reference
+    // simulate() is checked against
+    PathValue valuePath(const LoanTable &loans, const DepositTable &deposits,
+                        const RateModel &model, const double *rate);
+
+    // stats of field (e.g. &PathValue::loanValue) over n paths
+    PathStats stats(const PathValue *values, std::size_t n, double PathValue::*field);
+}
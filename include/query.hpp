@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+#include "ds_bitmap.hpp"
+#include "ds_range.hpp"
+
+// ---------------------------------------------------------
+// Conjunctive queries over a book:
+//   months <= 12 AND rate >= 7.5 AND amount > 10000
+// Every field a book exposes is backed by a BitmapIndex (few distinct
+// values: rates, tenures) or a RangeIndex (amounts). The bitmap
+// conditions are ANDed first, smallest first. Range conditions follow,
+// narrowest first, each the cheapest of three ways: probe its rows
+// against the candidates, drop the few rows outside it when it covers
+// nearly everything, or, when fewer candidates are left than either,
+// check the candidates against the field directly at the end.
+// ---------------------------------------------------------
+namespace Query
+{
+    enum class Op
+    {
+        Less,
+        LessEq,
+        Equal,
+        GreaterEq,
+        Greater
+    };
+
+    struct Condition
+    {
+        std::string field;
+        Op op = Op::Equal;
+        double value = 0;
+    };
+
+    // one field of a book; exactly one of the index pointers is set
+    struct Field
+    {
+        std::string name;
+        const BitmapIndex<double> *doubleBits = nullptr;
+        const BitmapIndex<int> *intBits = nullptr;
+        const RangeIndex<double> *doubleRange = nullptr;
+        std::function<double(std::size_t)> valueOf; // row -> value, for range filtering
+    };
+
+    // "field op value [AND field op value ...]", op one of < <= = == >= >,
+    // AND in any case; false with a message on anything else
+    bool parse(const std::string &text, std::vector<Condition> &out, std::string &error);
+
+    // rows matching every condition, ascending; false with a message
+    // on a field the book doesn't have
+    bool run(const std::vector<Field> &fields, const std::vector<Condition> &conditions,
+             std::vector<std::size_t> &rows, std::string &error);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) && !defined(FINCALC_SCALAR_KERNELS)
+#include <immintrin.h>
+#define FINCALC_KERNEL_LANES 8
+#elif defined(__AVX2__) && defined(__FMA__) && !defined(FINCALC_SCALAR_KERNELS)
+#include <immintrin.h>
+#define FINCALC_KERNEL_LANES 4
+#else
+#define FINCALC_KERNEL_LANES 1
+#endif
+
+// ---------------------------------------------------------
+// Batch growth factors (1 + r)^n with an integer n, the std::pow
+// calls behind compound interest and EMI.
+// n is taken by squaring in double-double (a value plus its rounding
+// error, both carried through every product), so the rounded result
+// stays within 1 ULP of std::pow where plain squaring drifts by
+// hundreds of ULPs at 30-year terms. LANES loans go through at once:
+// AVX-512F (8) or AVX2 + FMA (4), and both give the same bits. Without
+// them, or with -DFINCALC_SCALAR_KERNELS, it is std::pow per loan,
+// which a one-lane double-double loop can't beat. The n % LANES rows
+// at the end, blocks with a negative exponent and results that
+// overflow (or NaN rates) take std::pow too.
+// ---------------------------------------------------------
+namespace RateKernels
+{
+    constexpr std::size_t LANES = FINCALC_KERNEL_LANES;
+
+    // out[i] = (1 + rate[i] / divisor) ^ (periods[i] * periodsPer), one loan at a time
+    inline void growthScalar(const double *rate, double divisor, const int *periods, int periodsPer,
+                             std::size_t n, double *out)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = std::pow(1 + rate[i] / divisor, periods[i] * periodsPer);
+    }
+
+#if FINCALC_KERNEL_LANES > 1
+    // LANES doubles
+    struct Vec
+    {
+#if FINCALC_KERNEL_LANES == 8
+        __m512d v;
+        Vec() = default;
+        Vec(__m512d x) : v(x) {}
+        Vec(double x) : v(_mm512_set1_pd(x)) {}
+        static Vec load(const double *p) { return _mm512_loadu_pd(p); }
+        void store(double *p) const { _mm512_storeu_pd(p, v); }
+        friend Vec operator+(Vec a, Vec b) { return _mm512_add_pd(a.v, b.v); }
+        friend Vec operator-(Vec a, Vec b) { return _mm512_sub_pd(a.v, b.v); }
+        friend Vec operator*(Vec a, Vec b) { return _mm512_mul_pd(a.v, b.v); }
+        friend Vec operator/(Vec a, Vec b) { return _mm512_div_pd(a.v, b.v); }
+        friend Vec fma(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(a.v, b.v, c.v); }
+        // a * b - p exactly, for p = a * b rounded
+        friend Vec productError(Vec a, Vec b, Vec p) { return _mm512_fmsub_pd(a.v, b.v, p.v); }
+        // x - x is 0 unless x is inf or NaN
+        bool allFinite() const
+        {
+            return _mm512_cmp_pd_mask(_mm512_sub_pd(v, v), _mm512_setzero_pd(), _CMP_EQ_OQ) == 0xFF;
+        }
+#else
+        __m256d v;
+        Vec() = default;
+        Vec(__m256d x) : v(x) {}
+        Vec(double x) : v(_mm256_set1_pd(x)) {}
+        static Vec load(const double *p) { return _mm256_loadu_pd(p); }
+        void store(double *p) const { _mm256_storeu_pd(p, v); }
+        friend Vec operator+(Vec a, Vec b) { return _mm256_add_pd(a.v, b.v); }
+        friend Vec operator-(Vec a, Vec b) { return _mm256_sub_pd(a.v, b.v); }
+        friend Vec operator*(Vec a, Vec b) { return _mm256_mul_pd(a.v, b.v); }
+        friend Vec operator/(Vec a, Vec b) { return _mm256_div_pd(a.v, b.v); }
+        friend Vec fma(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(a.v, b.v, c.v); }
+        friend Vec productError(Vec a, Vec b, Vec p) { return _mm256_fmsub_pd(a.v, b.v, p.v); }
+        bool allFinite() const
+        {
+            return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_sub_pd(v, v), _mm256_setzero_pd(), _CMP_EQ_OQ)) == 0xF;
+        }
+#endif
+    };
+
+    // LANES int exponents; pick() chooses per lane on one bit
+    struct Exps
+    {
+#if FINCALC_KERNEL_LANES == 8
+        __m256i e;
+        Exps() = default;
+        Exps(const int *p, int mult)
+            : e(_mm256_mullo_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)),
+                                   _mm256_set1_epi32(mult))) {}
+        Vec pick(unsigned bit, Vec set, Vec clear) const
+        {
+            __mmask16 m = _mm512_test_epi32_mask(_mm512_castsi256_si512(e),
+                                                 _mm512_set1_epi32(static_cast<int>(1u << bit)));
+            return _mm512_mask_blend_pd(static_cast<__mmask8>(m), clear.v, set.v);
+        }
+        bool anyNegative() const { return _mm256_movemask_ps(_mm256_castsi256_ps(e)) != 0; }
+        // OR of the lanes
+        std::uint32_t bits() const
+        {
+            __m128i x = _mm_or_si128(_mm256_castsi256_si128(e), _mm256_extracti128_si256(e, 1));
+            x = _mm_or_si128(x, _mm_shuffle_epi32(x, 0x4E));
+            x = _mm_or_si128(x, _mm_shuffle_epi32(x, 0xB1));
+            return static_cast<std::uint32_t>(_mm_cvtsi128_si32(x));
+        }
+#else
+        __m128i e;
+        __m256i wide; // e as 64-bit lanes, for the blend masks
+        Exps() = default;
+        Exps(const int *p, int mult)
+            : e(_mm_mullo_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)),
+                                _mm_set1_epi32(mult))),
+              wide(_mm256_cvtepi32_epi64(e)) {}
+        Vec pick(unsigned bit, Vec set, Vec clear) const
+        {
+            // blendv goes by the sign bit: move `bit` up there
+            __m256i m = _mm256_sll_epi64(wide, _mm_cvtsi32_si128(static_cast<int>(63 - bit)));
+            return _mm256_blendv_pd(clear.v, set.v, _mm256_castsi256_pd(m));
+        }
+        bool anyNegative() const { return _mm_movemask_ps(_mm_castsi128_ps(e)) != 0; }
+        std::uint32_t bits() const
+        {
+            __m128i x = _mm_or_si128(e, _mm_shuffle_epi32(e, 0x4E));
+            x = _mm_or_si128(x, _mm_shuffle_epi32(x, 0xB1));
+            return static_cast<std::uint32_t>(_mm_cvtsi128_si32(x));
+        }
+#endif
+    };
+
+    // base^e per lane; bits is the OR of the lanes' exponents.
+    // The low words only ever hold a few ULPs of the high ones, so they
+    // are left unnormalized until the final rounding.
+    inline Vec powi(Vec base, const Exps &e, std::uint32_t bits)
+    {
+        Vec rh = 1.0, rl = 0.0;  // result
+        Vec bh = base, bl = 0.0; // base^(2^bit)
+        for (unsigned bit = 0;; ++bit)
+        {
+            // r *= (bit set ? b : 1)
+            Vec fh = e.pick(bit, bh, 1.0), fl = e.pick(bit, bl, 0.0);
+            Vec p = rh * fh;
+            rl = fma(rl, fh, fma(rh, fl, productError(rh, fh, p)));
+            rh = p;
+            if ((bits >> bit) <= 1)
+                break;
+            // b *= b
+            p = bh * bh;
+            bl = fma(bh + bh, bl, productError(bh, bh, p));
+            bh = p;
+        }
+        return rh + rl;
+    }
+#endif
+
+    // out[i] = (1 + rate[i] / divisor) ^ (periods[i] * periodsPer)
+    // e.g. divisor 1200 and periodsPer 12 turn yearly % and years into
+    // the monthly EMI growth
+    inline void growth(const double *rate, double divisor, const int *periods, int periodsPer,
+                       std::size_t n, double *out)
+    {
+        std::size_t i = 0;
+#if FINCALC_KERNEL_LANES > 1
+        for (; i + LANES <= n; i += LANES)
+        {
+            Exps e(periods + i, periodsPer);
+            if (!e.anyNegative())
+            {
+                Vec g = powi(1.0 + Vec::load(rate + i) / divisor, e, e.bits());
+                g.store(out + i);
+                if (g.allFinite())
+                    continue;
+            }
+            growthScalar(rate + i, divisor, periods + i, periodsPer, LANES, out + i);
+        }
+#endif
+        growthScalar(rate + i, divisor, periods + i, periodsPer, n - i, out + i);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "loans.hpp"
+#include "deposits.hpp"
+
+class ThreadPool;
+
+// one what-if: every rate moved by rateShift percentage points
+// (0.5 = +50bp) and every term by termShift months
+struct Scenario
+{
+    double rateShift = 0;
+    int termShift = 0;
+};
+
+// the book under one scenario; records whose term is gone (<= 0
+// months after the shift) are left out
+struct ScenarioTotals
+{
+    std::size_t loans = 0;
+    double emi = 0;          // monthly payments
+    double loanInterest = 0; // EMI * months - principal
+    std::size_t deposits = 0;
+    double maturity = 0;        // amount + simple interest
+    double depositInterest = 0;
+};
+
+// ---------------------------------------------------------
+// Rate-shock engine: reprices every loan (EMI through
+// RateKernels::growth) and deposit (maturity) under every scenario.
+// Records go in tiles of TILE_ROWS: a tile's columns and scratch
+// (~40 KB) stay in cache while all the scenarios run over it, so each
+// record comes from memory once. Runs of TILES_PER_TASK tiles are
+// spread over the pool and their partial totals added in book order,
+// so the sums come out the same whatever the thread count.
+// ---------------------------------------------------------
+namespace Scenarios
+{
+    constexpr std::size_t TILE_ROWS = 1024;
+    constexpr std::size_t TILES_PER_TASK = 16;
+
+    // every rateShift with every termShift, rates varying fastest
+    std::vector<Scenario> grid(const std::vector<double> &rateShifts, const std::vector<int> &termShifts);
+
+    // totals[s] is the book under scenarios[s]
+    std::vector<ScenarioTotals> run(const LoanTable &loans, const DepositTable &deposits,
+                                    const std::vector<Scenario> &scenarios, ThreadPool &pool);
+}
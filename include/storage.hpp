@@ -1,18 +1,258 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
 #include "deposits.hpp"
 #include "credit.hpp"
 #include "loans.hpp"
+#include "thread_pool.hpp"
 
 namespace Storage
 {
+    // load* read either format: a file that starts with the .col magic
+    // is loaded as binary columns, anything else is parsed as text
+    // ("name amount rate term" per line; the name may contain spaces).
+    // Malformed text lines are reported on stderr as path:line and
+    // skipped. load* return false only when the file can't be read.
+    // save* write text (numbers at full precision); save*Binary write the
+    // columnar format. Both write <path>.tmp, fsync it and rename it over
+    // path, so a crash leaves either the old file or the new one.
     bool saveDeposits(const std::vector<Deposit> &deps, const std::string &path);
     bool loadDeposits(std::vector<Deposit> &deps, const std::string &path);
+    bool loadDeposits(DepositTable &deps, const std::string &path);
+    bool saveDepositsBinary(const DepositTable &deps, const std::string &path);
 
     bool saveCredits(const std::vector<CreditRecord> &creds, const std::string &path);
     bool loadCredits(std::vector<CreditRecord> &creds, const std::string &path);
+    bool loadCredits(CreditTable &creds, const std::string &path);
+    bool saveCreditsBinary(const CreditTable &creds, const std::string &path);
 
     bool saveLoans(const std::vector<Loan> &loans, const std::string &path);
     bool loadLoans(std::vector<Loan> &loans, const std::string &path);
+    bool loadLoans(LoanTable &loans, const std::string &path);
+    bool saveLoansBinary(const LoanTable &loans, const std::string &path);
+
+    // ---------------------------------------------------------
+    // Parallel text loading. A text file of at least two chunks of
+    // PARALLEL_LOAD_CHUNK bytes is cut at newlines into up to four
+    // chunks per pool thread; each chunk is parsed on its own into its
+    // own rows, and the chunks are joined in file order. Bad lines are
+    // still reported with their line in the whole file. The overloads
+    // above run on ThreadPool::shared().
+    //
+    // LoadInfo carries what the parsing threads learned, so index builds
+    // need not make their own pass: rows per chunk, std::hash of every
+    // name (StringIntMap::build takes them) and the total name bytes.
+    // It stays empty after a binary load.
+    // ---------------------------------------------------------
+    constexpr std::size_t PARALLEL_LOAD_CHUNK = std::size_t(4) << 20;
+
+    struct LoadInfo
+    {
+        std::vector<std::size_t> chunkRows;
+        std::vector<std::size_t> nameHash; // per row
+        std::size_t nameBytes = 0;
+
+        void clear()
+        {
+            chunkRows.clear();
+            nameHash.clear();
+            nameBytes = 0;
+        }
+
+        // name hashes for a book of `rows` rows, or null if they don't match it
+        const std::size_t *nameHashes(std::size_t rows) const
+        {
+            return nameHash.size() == rows && rows > 0 ? nameHash.data() : nullptr;
+        }
+    };
+
+    bool loadDeposits(std::vector<Deposit> &deps, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+    bool loadDeposits(DepositTable &deps, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+    bool loadCredits(std::vector<CreditRecord> &creds, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+    bool loadCredits(CreditTable &creds, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+    bool loadLoans(std::vector<Loan> &loans, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+    bool loadLoans(LoanTable &loans, const std::string &path, ThreadPool &pool, LoadInfo *info = nullptr);
+
+    // ---------------------------------------------------------
+    // Binary columnar format (.col), version 1. All three books have
+    // the same shape: name, two doubles, one int.
+    //
+    //   header (ColumnFileHeader, 88 bytes)
+    //   name offsets : (rows + 1) x uint64 into the heap
+    //   amount       : rows x double   (principal / amount)
+    //   rate         : rows x double   (rate / interest)
+    //   term         : rows x int32    (years / months)
+    //   heap         : name bytes, back to back, no terminators
+    //
+    // Every section starts on an 8-byte boundary and is addressed by
+    // its offset from the start of the file. Numbers are stored in
+    // host byte order; byteOrder lets a reader on the other order
+    // reject the file instead of misreading it.
+    // ---------------------------------------------------------
+    constexpr std::uint32_t COLUMN_FILE_VERSION = 1;
+    constexpr std::uint32_t COLUMN_FILE_BYTE_ORDER = 0x01020304;
+
+    enum class BookKind : std::uint32_t
+    {
+        Deposits = 1,
+        Loans = 2,
+        Credits = 3
+    };
+
+    struct ColumnFileHeader
+    {
+        char magic[8]; // "FINCOL\0\0"
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t kind; // BookKind
+        std::uint32_t reserved;
+        std::uint64_t rows;
+        std::uint64_t nameOffsets;
+        std::uint64_t amount;
+        std::uint64_t rate;
+        std::uint64_t term;
+        std::uint64_t heap;
+        std::uint64_t heapSize;
+        std::uint64_t fileSize;
+    };
+
+    bool isColumnFile(const std::string &path);
+
+    // Read-only mmap of a .col file. open() checks the header and that
+    // every section lies inside the file; after that the accessors
+    // point straight into the mapping, nothing is parsed or copied.
+    class MappedColumns
+    {
+    public:
+        MappedColumns() = default;
+        ~MappedColumns();
+        MappedColumns(const MappedColumns &) = delete;
+        MappedColumns &operator=(const MappedColumns &) = delete;
+
+        bool open(const std::string &path, BookKind kind);
+        void close();
+
+        std::size_t rows() const { return rows_; }
+        std::string_view name(std::size_t i) const
+        {
+            return std::string_view(heap_ + nameOffsets_[i], nameOffsets_[i + 1] - nameOffsets_[i]);
+        }
+        const double *amount() const { return amount_; }
+        const double *rate() const { return rate_; }
+        const std::int32_t *term() const { return term_; }
+
+    private:
+        void *map_ = nullptr;
+        std::size_t mapSize_ = 0;
+        std::size_t rows_ = 0;
+        const std::uint64_t *nameOffsets_ = nullptr;
+        const double *amount_ = nullptr;
+        const double *rate_ = nullptr;
+        const std::int32_t *term_ = nullptr;
+        const char *heap_ = nullptr;
+    };
+
+    // ---------------------------------------------------------
+    // Streaming text reader for batch jobs: a book (or stdin, path "-")
+    // is read in blocks of BATCH_READ_BLOCK bytes and handed out as
+    // tables of at most batchRows rows, so memory is one block plus one
+    // batch whatever the input size (a block grows only to hold a
+    // longer line). Bad lines are reported as path:line, as by load*.
+    // ---------------------------------------------------------
+    constexpr std::size_t BATCH_READ_BLOCK = std::size_t(1) << 20;
+
+    template <typename Table>
+    class BatchReader
+    {
+    public:
+        explicit BatchReader(std::size_t batchRows);
+        ~BatchReader();
+        BatchReader(const BatchReader &) = delete;
+        BatchReader &operator=(const BatchReader &) = delete;
+
+        bool open(const std::string &path);
+        // next rows into batch (cleared first); false once the input is done
+        bool next(Table &batch);
+        bool failed() const { return failed_; } // a read error ended the input
+
+    private:
+        std::string path_;
+        int fd_ = -1;
+        std::size_t batchRows_;
+        std::vector<char> buf_;
+        std::size_t begin_ = 0, end_ = 0; // unparsed bytes in buf_
+        bool eof_ = false;
+        bool failed_ = false;
+        std::size_t lineBase_ = 0; // lines before buf_[begin_]
+        std::size_t badLines_ = 0;
+
+        void fill();
+    };
+
+    // ---------------------------------------------------------
+    // Write-ahead journal for a book. Every add / update / delete is
+    // appended to <book>.journal.<gen> as one line and synced before the
+    // call returns, so a change costs I/O proportional to the change and
+    // survives a crash. load() reads the book and replays the journals
+    // on top of it. Once a journal gets long, compact() writes a fresh
+    // snapshot of the book from a background thread (temp file, fsync,
+    // rename) while the next generation takes the new writes.
+    //
+    // Journal lines: "A name amount rate term", "U idx name amount rate
+    // term", "D idx" (swap-and-pop, like the menus) and "R" (clear).
+    // The first line of each journal names the snapshot it applies to
+    // by device and inode. Installing a snapshot by rename gives the
+    // book a new inode, which is how load() tells which journals the
+    // snapshot already contains.
+    // ---------------------------------------------------------
+    constexpr std::size_t JOURNAL_COMPACT_MIN_ENTRIES = 1024;
+
+    template <typename Record>
+    class Journal
+    {
+    public:
+        explicit Journal(std::string bookPath);
+        ~Journal(); // waits for a running compaction
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+
+        // book + journal replay; false only if the book exists but can't be
+        // read. info is filled as by load* when no journal entry applied.
+        bool load(std::vector<Record> &records, LoadInfo *info = nullptr);
+
+        // false (and a message on stderr) if the entry could not be synced
+        bool add(const Record &r);
+        bool update(std::size_t idx, const Record &r);
+        bool remove(std::size_t idx);
+        bool replaceAll(const std::vector<Record> &records); // reset / load sample
+
+        // compacts once the journal holds at least JOURNAL_COMPACT_MIN_ENTRIES
+        // entries and at least a quarter as many as the book has rows
+        void maybeCompact(const std::vector<Record> &records);
+        void compact(const std::vector<Record> &records);
+        // compact() only if something changed since the last snapshot
+        void checkpoint(const std::vector<Record> &records);
+        void wait();
+
+        std::size_t entries() const { return entries_; }
+        bool dirty() const { return entries_ > 0; }
+
+    private:
+        std::string book_;
+        int fd_ = -1;           // current generation, opened on first write
+        std::uint64_t gen_ = 1; // current generation
+        std::uint64_t baseDev_ = 0, baseIno_ = 0; // snapshot it applies to
+        std::size_t entries_ = 0; // since the last snapshot
+        bool binary_ = false;     // book is a .col file
+        std::thread compactor_;
+        std::atomic<bool> compactorDone_{true};
+
+        bool append(const std::string &lines, std::size_t count);
+        void closeGeneration();
+    };
 }
@@ -0,0 +1,199 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------
+// Work-stealing thread pool for fork-join style jobs.
+// Every worker owns a deque: it pushes/pops its own work at the back
+// (LIFO, cache-warm) and steals from the front of the others (FIFO,
+// the biggest pieces). `threads` counts the caller too: a thread that
+// waits on a TaskGroup runs queued tasks instead of blocking, so
+// ThreadPool(1) has no workers and everything runs inline.
+// ---------------------------------------------------------
+class ThreadPool
+{
+    struct Queue
+    {
+        std::mutex m;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] for outside threads
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    std::atomic<std::size_t> queued{0};
+    std::mutex sleepM;
+    std::condition_variable wake;
+
+    // which queue the current thread owns in which pool
+    static thread_local ThreadPool *tlPool;
+    static thread_local std::size_t tlQueue;
+
+    std::size_t myQueue() const { return tlPool == this ? tlQueue : 0; }
+
+    bool popFrom(std::size_t q, bool back, std::function<void()> &out)
+    {
+        Queue &queue = *queues[q];
+        std::lock_guard<std::mutex> lock(queue.m);
+        if (queue.tasks.empty())
+            return false;
+        if (back)
+        {
+            out = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        --queued;
+        return true;
+    }
+
+    void workerLoop(std::size_t q)
+    {
+        tlPool = this;
+        tlQueue = q;
+        while (!stopping)
+        {
+            if (runOne())
+                continue;
+            std::unique_lock<std::mutex> lock(sleepM);
+            wake.wait(lock, [this]()
+                      { return stopping || queued > 0; });
+        }
+    }
+
+public:
+    explicit ThreadPool(std::size_t threads)
+    {
+        std::size_t n = threads == 0 ? 1 : threads;
+        for (std::size_t i = 0; i < n; ++i)
+            queues.push_back(std::make_unique<Queue>());
+        for (std::size_t i = 1; i < n; ++i)
+            workers.emplace_back([this, i]()
+                                 { workerLoop(i); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepM);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // caller included
+    std::size_t threadCount() const { return queues.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        Queue &queue = *queues[myQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.m);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepM);
+            ++queued;
+        }
+        wake.notify_one();
+    }
+
+    // run one task: own queue first, then steal. false if all were empty
+    bool runOne()
+    {
+        std::function<void()> task;
+        std::size_t self = myQueue();
+        bool found = popFrom(self, true, task);
+        for (std::size_t i = 1; !found && i < queues.size(); ++i)
+            found = popFrom((self + i) % queues.size(), false, task);
+        if (!found)
+            return false;
+        task();
+        return true;
+    }
+
+    // one pool for the whole program, sized to the machine
+    static ThreadPool &shared()
+    {
+        static ThreadPool pool(std::thread::hardware_concurrency());
+        return pool;
+    }
+};
+
+inline thread_local ThreadPool *ThreadPool::tlPool = nullptr;
+inline thread_local std::size_t ThreadPool::tlQueue = 0;
+
+// ---------------------------------------------------------
+// TaskGroup : fork some tasks, then wait() for all of them while
+// helping the pool run work (so nested forks never deadlock). A task
+// that throws still counts as done; wait() rethrows the first such
+// exception once every task has finished. The destructor only waits,
+// so an exception nobody wait()ed for is dropped.
+// ---------------------------------------------------------
+class TaskGroup
+{
+    ThreadPool &pool;
+    std::atomic<std::size_t> pending{0};
+    std::mutex errorM;
+    std::exception_ptr error; // first exception a task threw
+
+    void drain()
+    {
+        while (pending > 0)
+        {
+            if (!pool.runOne())
+                std::this_thread::yield();
+        }
+    }
+
+public:
+    explicit TaskGroup(ThreadPool &p) : pool(p) {}
+    ~TaskGroup() { drain(); }
+
+    template <typename F>
+    void run(F &&fn)
+    {
+        ++pending;
+        pool.submit([this, fn = std::forward<F>(fn)]() mutable
+                    {
+            try
+            {
+                fn();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorM);
+                if (!error)
+                    error = std::current_exception();
+            }
+            --pending; });
+    }
+
+    void wait()
+    {
+        drain();
+        std::exception_ptr thrown;
+        {
+            std::lock_guard<std::mutex> lock(errorM);
+            thrown.swap(error);
+        }
+        if (thrown)
+            std::rethrow_exception(thrown);
+    }
+};
@@ -4,9 +4,16 @@
 #include <string>
 #include <functional>
 #include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <charconv>
+#include <utility>
+#include <type_traits>
 #include "deposits.hpp"
 #include "loans.hpp"
 #include "credit.hpp"
+#include "thread_pool.hpp"
 
 namespace Utilities
 {
@@ -22,6 +29,157 @@ namespace Utilities
         std::getline(std::cin, out);
     }
 
+    // ---------------- buffered output ----------------
+    // display rows are formatted into one reusable std::string and
+    // written with a single call, not a stream insertion per field.
+    // Numbers come out the way operator<< prints them by default.
+    constexpr std::size_t OUTPUT_FLUSH_BYTES = 1 << 20;
+
+    inline void appendNumber(std::string &out, double v)
+    {
+        char buf[32];
+        auto end = std::to_chars(buf, buf + sizeof buf, v, std::chars_format::general, 6).ptr; // %g
+        out.append(buf, static_cast<std::size_t>(end - buf));
+    }
+
+    inline void appendNumber(std::string &out, int v)
+    {
+        char buf[16];
+        auto end = std::to_chars(buf, buf + sizeof buf, v).ptr;
+        out.append(buf, static_cast<std::size_t>(end - buf));
+    }
+
+    // v with a fixed number of decimals, like std::fixed << setprecision
+    inline void appendFixed(std::string &out, double v, int decimals)
+    {
+        char buf[352]; // room for DBL_MAX in full
+        auto end = std::to_chars(buf, buf + sizeof buf, v, std::chars_format::fixed, decimals).ptr;
+        out.append(buf, static_cast<std::size_t>(end - buf));
+    }
+
+    inline void writeOut(std::string &out)
+    {
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+        out.clear();
+    }
+
+    // the positions [first, last) of a page of `limit` rows starting
+    // at `offset`, clipped to a view of `size` rows
+    inline std::pair<std::size_t, std::size_t> pageOf(std::size_t size, std::size_t offset, std::size_t limit)
+    {
+        std::size_t first = offset < size ? offset : size;
+        std::size_t last = size - first < limit ? size : first + limit;
+        return {first, last};
+    }
+
+    // ---------------- view maintenance ----------------
+    // A sorted view is ordered by (record, row): records that tie in
+    // comp go by row (sortView / radixSortView below). That makes every
+    // entry's place unique, so an update or a delete finds it by binary
+    // search instead of walking a run of equal keys.
+    template <typename Data, typename Compare>
+    bool viewBefore(const Data &a, std::size_t rowA, const Data &b, std::size_t rowB, Compare comp)
+    {
+        return comp(a, b) || (!comp(b, a) && rowA < rowB);
+    }
+
+    // first position in [lo, hi) of a sorted view not before (key, row)
+    template <typename Data, typename Compare>
+    std::size_t lowerBoundInView(const std::vector<std::size_t> &order, std::size_t lo, std::size_t hi,
+                                 const std::vector<Data> &data, const Data &key, std::size_t row, Compare comp)
+    {
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (viewBefore(data[order[mid]], order[mid], key, row, comp))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // swap-and-pop delete support: drop idx from a view order and
+    // rename `moved` (the old last slot) to idx, in one pass
+    inline void dropFromView(std::vector<std::size_t> &order,
+                             std::size_t idx, std::size_t moved)
+    {
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            std::size_t v = order[i];
+            if (v == idx)
+                continue;
+            order[out++] = (v == moved) ? idx : v;
+        }
+        order.resize(out);
+    }
+
+    // same, for a sorted view: data[idx] already holds the moved record,
+    // which keeps its key but now sorts by row idx, so its entry is
+    // dropped in the pass and put back at its new place
+    template <typename Data, typename Compare>
+    void dropFromView(std::vector<std::size_t> &order, const std::vector<Data> &data,
+                      std::size_t idx, std::size_t moved, Compare comp)
+    {
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            std::size_t v = order[i];
+            if (v != idx && v != moved)
+                order[out++] = v;
+        }
+        order.resize(out);
+        if (idx != moved)
+        {
+            std::size_t at = lowerBoundInView(order, 0, out, data, data[idx], idx, comp);
+            order.insert(order.begin() + at, idx);
+        }
+    }
+
+    // data[idx] changed from `before` to its current value: move idx to
+    // its new place in a sorted view. Old and new positions are binary
+    // searched; only the entries in between shift by one.
+    template <typename Data, typename Compare>
+    void repositionInView(std::vector<std::size_t> &order, const std::vector<Data> &data,
+                          std::size_t idx, const Data &before, Compare comp)
+    {
+        const std::size_t n = order.size();
+
+        // old position: idx itself still sorts as (before, idx)
+        std::size_t lo = 0, hi = n;
+        while (lo < hi)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            const Data &at = (order[mid] == idx) ? before : data[order[mid]];
+            if (viewBefore(at, order[mid], before, idx, comp))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        std::size_t p = lo;
+        if (p == n || order[p] != idx)
+            return;
+
+        const Data &now = data[idx];
+        if (p > 0 && viewBefore(now, idx, data[order[p - 1]], order[p - 1], comp))
+        {
+            // moves left: before the first entry not before (now, idx)
+            std::size_t q = lowerBoundInView(order, 0, p, data, now, idx, comp);
+            for (std::size_t i = p; i > q; --i)
+                order[i] = order[i - 1];
+            order[q] = idx;
+        }
+        else if (p + 1 < n && viewBefore(data[order[p + 1]], order[p + 1], now, idx, comp))
+        {
+            // moves right: just before the first entry not before (now, idx)
+            std::size_t q = lowerBoundInView(order, p + 1, n, data, now, idx, comp);
+            for (std::size_t i = p; i + 1 < q; ++i)
+                order[i] = order[i + 1];
+            order[q - 1] = idx;
+        }
+    }
+
     // ---------------- search ----------------
     template <typename T, typename Compare = std::less<T>>
     int linearSearch(const std::vector<T> &arr, const T &key, Compare comp = Compare())
@@ -87,143 +245,702 @@ namespace Utilities
         }
     }
 
-    // ---------------- improved quicksort ----------------
-    constexpr int QS_INSERTION_THRESHOLD = 16;
+    // ---------------- pattern-defeating quicksort ----------------
+    // pdqsort-style engine behind quickSort / quickSortIndices:
+    //  - pivot: median of 3, or ninther (median of 3 medians) above 128
+    //  - a range whose pivot equals the element before it is a run of
+    //    equal keys: partition "equal goes left" and skip the whole run,
+    //    so few distinct values (rate, months) cost O(n) per value
+    //  - already partitioned ranges try a bounded insertion sort first,
+    //    so sorted / nearly sorted imports finish in O(n)
+    //  - unbalanced partitions shuffle a few elements; after log2(n) of
+    //    them the range is heapsorted, so the worst case is O(n log n)
+    //  - primitive elements (index views included) use the branchless
+    //    block partition from BlockQuicksort
+    constexpr int QS_INSERTION_THRESHOLD = 24;
+    constexpr int QS_NINTHER_THRESHOLD = 128;
+    constexpr int QS_PARTIAL_INSERTION_LIMIT = 8;
+    constexpr int QS_BLOCK_SIZE = 64;
 
     template <typename T, typename Compare>
-    int partition(std::vector<T> &arr, int low, int high, Compare comp)
+    void pdqInsertionSort(T *begin, T *end, Compare comp)
     {
-        // use middle element as pivot to avoid worst-case on sorted data
-        T pivot = arr[low + (high - low) / 2];
-        int i = low;
-        int j = high;
-        while (i <= j)
+        if (begin == end)
+            return;
+        for (T *cur = begin + 1; cur != end; ++cur)
         {
-            while (comp(arr[i], pivot))
-                ++i;
-            while (comp(pivot, arr[j]))
-                --j;
-            if (i <= j)
+            T *sift = cur;
+            T *prev = cur - 1;
+            if (comp(*sift, *prev))
             {
-                std::swap(arr[i], arr[j]);
-                ++i;
-                --j;
+                T tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*prev);
+                } while (sift != begin && comp(tmp, *--prev));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    // same, but *(begin - 1) is known to be <= every element: no bounds check
+    template <typename T, typename Compare>
+    void pdqUnguardedInsertionSort(T *begin, T *end, Compare comp)
+    {
+        if (begin == end)
+            return;
+        for (T *cur = begin + 1; cur != end; ++cur)
+        {
+            T *sift = cur;
+            T *prev = cur - 1;
+            if (comp(*sift, *prev))
+            {
+                T tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*prev);
+                } while (comp(tmp, *--prev));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    // insertion sort that gives up after QS_PARTIAL_INSERTION_LIMIT moves
+    template <typename T, typename Compare>
+    bool pdqPartialInsertionSort(T *begin, T *end, Compare comp)
+    {
+        if (begin == end)
+            return true;
+        std::size_t moved = 0;
+        for (T *cur = begin + 1; cur != end; ++cur)
+        {
+            T *sift = cur;
+            T *prev = cur - 1;
+            if (comp(*sift, *prev))
+            {
+                T tmp = std::move(*sift);
+                do
+                {
+                    *sift-- = std::move(*prev);
+                } while (sift != begin && comp(tmp, *--prev));
+                *sift = std::move(tmp);
+                moved += cur - sift;
+            }
+            if (moved > static_cast<std::size_t>(QS_PARTIAL_INSERTION_LIMIT))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T, typename Compare>
+    void pdqHeapSort(T *begin, T *end, Compare comp)
+    {
+        std::ptrdiff_t n = end - begin;
+        auto siftDown = [&](std::ptrdiff_t root, std::ptrdiff_t size)
+        {
+            T value = std::move(begin[root]);
+            std::ptrdiff_t child;
+            while ((child = 2 * root + 1) < size)
+            {
+                if (child + 1 < size && comp(begin[child], begin[child + 1]))
+                    ++child;
+                if (!comp(value, begin[child]))
+                    break;
+                begin[root] = std::move(begin[child]);
+                root = child;
+            }
+            begin[root] = std::move(value);
+        };
+        for (std::ptrdiff_t i = n / 2 - 1; i >= 0; --i)
+            siftDown(i, n);
+        for (std::ptrdiff_t last = n - 1; last > 0; --last)
+        {
+            std::swap(begin[0], begin[last]);
+            siftDown(0, last);
+        }
+    }
+
+    template <typename T, typename Compare>
+    void pdqSort3(T *a, T *b, T *c, Compare comp)
+    {
+        if (comp(*b, *a))
+            std::swap(*a, *b);
+        if (comp(*c, *b))
+            std::swap(*b, *c);
+        if (comp(*b, *a))
+            std::swap(*a, *b);
+    }
+
+    // leaves the pivot in *begin
+    template <typename T, typename Compare>
+    void pdqChoosePivot(T *begin, T *end, Compare comp)
+    {
+        std::ptrdiff_t size = end - begin;
+        std::ptrdiff_t half = size / 2;
+        if (size > QS_NINTHER_THRESHOLD)
+        {
+            pdqSort3(begin, begin + half, end - 1, comp);
+            pdqSort3(begin + 1, begin + (half - 1), end - 2, comp);
+            pdqSort3(begin + 2, begin + (half + 1), end - 3, comp);
+            pdqSort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+            std::swap(*begin, begin[half]);
+        }
+        else
+        {
+            pdqSort3(begin + half, begin, end - 1, comp);
+        }
+    }
+
+    // pivot *begin; [begin, pos) < pivot <= [pos + 1, end).
+    // second = true if nothing had to be swapped.
+    template <typename T, typename Compare>
+    std::pair<T *, bool> pdqPartitionRight(T *begin, T *end, Compare comp)
+    {
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+
+        // the pivot is a median, so both scans stop before running off
+        while (comp(*++first, pivot))
+            ;
+        if (first - 1 == begin)
+            while (first < last && !comp(*--last, pivot))
+                ;
+        else
+            while (!comp(*--last, pivot))
+                ;
+
+        bool alreadyPartitioned = first >= last;
+        while (first < last)
+        {
+            std::swap(*first, *last);
+            while (comp(*++first, pivot))
+                ;
+            while (!comp(*--last, pivot))
+                ;
+        }
+
+        T *pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return {pivotPos, alreadyPartitioned};
+    }
+
+    // move the elements at the collected offsets across: plain swaps when
+    // both sides have the same count, a rotating cycle otherwise
+    template <typename T>
+    void pdqSwapOffsets(T *first, T *last, const unsigned char *offsetsL,
+                        const unsigned char *offsetsR, std::size_t num, bool useSwaps)
+    {
+        if (useSwaps)
+        {
+            for (std::size_t i = 0; i < num; ++i)
+                std::swap(first[offsetsL[i]], *(last - offsetsR[i]));
+        }
+        else if (num > 0)
+        {
+            T *l = first + offsetsL[0];
+            T *r = last - offsetsR[0];
+            T tmp = std::move(*l);
+            *l = std::move(*r);
+            for (std::size_t i = 1; i < num; ++i)
+            {
+                l = first + offsetsL[i];
+                *r = std::move(*l);
+                r = last - offsetsR[i];
+                *l = std::move(*r);
             }
+            *r = std::move(tmp);
         }
-        return i;
     }
 
+    // pdqPartitionRight without a data-dependent branch per element:
+    // each side records the offsets of misplaced elements for a block of
+    // QS_BLOCK_SIZE (the comparison result is added, not branched on),
+    // then the two offset lists are swapped pairwise.
     template <typename T, typename Compare>
-    void quickSortRec(std::vector<T> &arr, int low, int high, Compare comp)
+    std::pair<T *, bool> pdqPartitionRightBranchless(T *begin, T *end, Compare comp)
     {
-        while (low < high)
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+
+        while (comp(*++first, pivot))
+            ;
+        if (first - 1 == begin)
+            while (first < last && !comp(*--last, pivot))
+                ;
+        else
+            while (!comp(*--last, pivot))
+                ;
+
+        bool alreadyPartitioned = first >= last;
+        if (!alreadyPartitioned)
         {
-            // small section → insertion sort
-            if (high - low < QS_INSERTION_THRESHOLD)
+            std::swap(*first, *last);
+            ++first;
+
+            alignas(64) unsigned char offsetsL[QS_BLOCK_SIZE];
+            alignas(64) unsigned char offsetsR[QS_BLOCK_SIZE];
+            T *baseL = first;
+            T *baseR = last;
+            std::size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+            while (first < last)
             {
-                for (int i = low + 1; i <= high; ++i)
+                // fill whichever offset lists are empty; once fewer than two
+                // blocks remain, split what is left between them
+                std::size_t unknown = last - first;
+                std::size_t splitL = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+                std::size_t splitR = numR == 0 ? (unknown - splitL) : 0;
+                if (splitL > static_cast<std::size_t>(QS_BLOCK_SIZE))
+                    splitL = QS_BLOCK_SIZE;
+                if (splitR > static_cast<std::size_t>(QS_BLOCK_SIZE))
+                    splitR = QS_BLOCK_SIZE;
+
+                for (std::size_t i = 0; i < splitL;)
+                {
+                    offsetsL[numL] = static_cast<unsigned char>(i++);
+                    numL += !comp(*first, pivot);
+                    ++first;
+                }
+                for (std::size_t i = 0; i < splitR;)
                 {
-                    T key = arr[i];
-                    int j = i - 1;
-                    while (j >= low && comp(key, arr[j]))
-                    {
-                        arr[j + 1] = arr[j];
-                        --j;
-                    }
-                    arr[j + 1] = key;
+                    offsetsR[numR] = static_cast<unsigned char>(++i);
+                    numR += comp(*--last, pivot);
                 }
+
+                std::size_t num = numL < numR ? numL : numR;
+                pdqSwapOffsets(baseL, baseR, offsetsL + startL, offsetsR + startR, num, numL == numR);
+                numL -= num;
+                numR -= num;
+                startL += num;
+                startR += num;
+                if (numL == 0)
+                {
+                    startL = 0;
+                    baseL = first;
+                }
+                if (numR == 0)
+                {
+                    startR = 0;
+                    baseR = last;
+                }
+            }
+
+            // one side may still hold misplaced elements: move them to the
+            // middle boundary
+            if (numL)
+            {
+                while (numL--)
+                    std::swap(baseL[offsetsL[startL + numL]], *--last);
+                first = last;
+            }
+            if (numR)
+            {
+                while (numR--)
+                    std::swap(*(baseR - offsetsR[startR + numR]), *first), ++first;
+                last = first;
+            }
+        }
+
+        T *pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return {pivotPos, alreadyPartitioned};
+    }
+
+    // pivot *begin; [begin, pos) <= pivot < (pos, end). Used when the pivot
+    // equals the element before the range: everything equal to it lands
+    // on the left, which is then already in its final place.
+    template <typename T, typename Compare>
+    T *pdqPartitionLeft(T *begin, T *end, Compare comp)
+    {
+        T pivot = std::move(*begin);
+        T *first = begin;
+        T *last = end;
+
+        while (comp(pivot, *--last))
+            ;
+        if (last + 1 == end)
+            while (first < last && !comp(pivot, *++first))
+                ;
+        else
+            while (!comp(pivot, *++first))
+                ;
+
+        while (first < last)
+        {
+            std::swap(*first, *last);
+            while (comp(pivot, *--last))
+                ;
+            while (!comp(pivot, *++first))
+                ;
+        }
+
+        T *pivotPos = last;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
+
+    template <typename T, typename Compare>
+    std::pair<T *, bool> pdqPartition(T *begin, T *end, Compare comp)
+    {
+        if constexpr (std::is_arithmetic<T>::value)
+            return pdqPartitionRightBranchless(begin, end, comp);
+        else
+            return pdqPartitionRight(begin, end, comp);
+    }
+
+    // a partition left less than 1/8 on one side: swap a few elements
+    // around so the next pivots don't hit the same pattern
+    template <typename T>
+    void pdqBreakPatterns(T *begin, T *pivotPos, T *end)
+    {
+        std::ptrdiff_t sizeL = pivotPos - begin;
+        std::ptrdiff_t sizeR = end - (pivotPos + 1);
+        if (sizeL >= QS_INSERTION_THRESHOLD)
+        {
+            std::swap(*begin, begin[sizeL / 4]);
+            std::swap(*(pivotPos - 1), *(pivotPos - sizeL / 4));
+            if (sizeL > QS_NINTHER_THRESHOLD)
+            {
+                std::swap(begin[1], begin[sizeL / 4 + 1]);
+                std::swap(begin[2], begin[sizeL / 4 + 2]);
+                std::swap(*(pivotPos - 2), *(pivotPos - (sizeL / 4 + 1)));
+                std::swap(*(pivotPos - 3), *(pivotPos - (sizeL / 4 + 2)));
+            }
+        }
+        if (sizeR >= QS_INSERTION_THRESHOLD)
+        {
+            std::swap(pivotPos[1], pivotPos[1 + sizeR / 4]);
+            std::swap(*(end - 1), *(end - sizeR / 4));
+            if (sizeR > QS_NINTHER_THRESHOLD)
+            {
+                std::swap(pivotPos[2], pivotPos[2 + sizeR / 4]);
+                std::swap(pivotPos[3], pivotPos[3 + sizeR / 4]);
+                std::swap(*(end - 2), *(end - (1 + sizeR / 4)));
+                std::swap(*(end - 3), *(end - (2 + sizeR / 4)));
+            }
+        }
+    }
+
+    inline int pdqLog2(std::size_t n)
+    {
+        int log = 0;
+        while (n >>= 1)
+            ++log;
+        return log;
+    }
+
+    // sorts [begin, end). leftmost = false means *(begin - 1) is a pivot
+    // from an earlier partition, <= everything in the range.
+    template <typename T, typename Compare>
+    void pdqSortLoop(T *begin, T *end, Compare comp, int badAllowed, bool leftmost)
+    {
+        while (true)
+        {
+            std::ptrdiff_t size = end - begin;
+            if (size < QS_INSERTION_THRESHOLD)
+            {
+                if (leftmost)
+                    pdqInsertionSort(begin, end, comp);
+                else
+                    pdqUnguardedInsertionSort(begin, end, comp);
                 return;
             }
 
-            int mid = partition(arr, low, high, comp);
+            pdqChoosePivot(begin, end, comp);
 
-            // recurse on smaller side first (better stack)
-            if (mid - low < high - mid)
+            // pivot equal to its predecessor: skip the run of equal keys
+            if (!leftmost && !comp(*(begin - 1), *begin))
             {
-                quickSortRec(arr, low, mid - 1, comp);
-                low = mid;
+                begin = pdqPartitionLeft(begin, end, comp) + 1;
+                continue;
             }
-            else
+
+            std::pair<T *, bool> part = pdqPartition(begin, end, comp);
+            T *pivotPos = part.first;
+            std::ptrdiff_t sizeL = pivotPos - begin;
+            std::ptrdiff_t sizeR = end - (pivotPos + 1);
+
+            if (sizeL < size / 8 || sizeR < size / 8)
             {
-                quickSortRec(arr, mid, high, comp);
-                high = mid - 1;
+                if (--badAllowed == 0)
+                {
+                    pdqHeapSort(begin, end, comp);
+                    return;
+                }
+                pdqBreakPatterns(begin, pivotPos, end);
+            }
+            else if (part.second && pdqPartialInsertionSort(begin, pivotPos, comp) &&
+                     pdqPartialInsertionSort(pivotPos + 1, end, comp))
+            {
+                return;
             }
+
+            // recurse left, loop on the right
+            pdqSortLoop(begin, pivotPos, comp, badAllowed, leftmost);
+            begin = pivotPos + 1;
+            leftmost = false;
         }
     }
 
     template <typename T, typename Compare>
     void quickSort(std::vector<T> &arr, Compare comp)
     {
-        if (!arr.empty())
-            quickSortRec(arr, 0, static_cast<int>(arr.size()) - 1, comp);
+        if (arr.size() > 1)
+            pdqSortLoop(arr.data(), arr.data() + arr.size(), comp, pdqLog2(arr.size()) + 1, true);
     }
 
-    // ---------------- index-based quicksort (improved) ----------------
+    // ---------------- index-based quicksort ----------------
+    // sorts the indices by the records they point at; same engine
+    // (index arrays take the branchless partition)
     template <typename Data, typename Compare>
-    int partitionIdx(std::vector<std::size_t> &idx, int low, int high,
-                     const std::vector<Data> &data, Compare comp)
+    void quickSortIndices(std::vector<std::size_t> &idx,
+                          const std::vector<Data> &data,
+                          Compare comp)
     {
-        std::size_t pivotIdx = idx[low + (high - low) / 2];
-        int i = low;
-        int j = high;
-        while (i <= j)
+        quickSort(idx, [&data, comp](std::size_t a, std::size_t b)
+                  { return comp(data[a], data[b]); });
+    }
+
+    // ---------------- top-K selection ----------------
+    // the k records that come first in comp order, in that order, without
+    // sorting the rest: a heap of the best k seen so far with the worst
+    // of them at the root, which every later record has to beat. O(n log k),
+    // and once the heap holds good records most of the rest lose a single
+    // comparison. Ties go to the lower index, so out is what the first k
+    // of a stable sort would be.
+    template <typename Data, typename Compare>
+    void topKIndices(std::vector<std::size_t> &out,
+                     const std::vector<Data> &data,
+                     std::size_t k,
+                     Compare comp)
+    {
+        out.clear();
+        if (k > data.size())
+            k = data.size();
+        if (k == 0)
+            return;
+
+        auto ahead = [&data, comp](std::size_t a, std::size_t b)
+        { return comp(data[a], data[b]) || (!comp(data[b], data[a]) && a < b); };
+        auto siftDown = [&](std::size_t root)
         {
-            while (comp(data[idx[i]], data[pivotIdx]))
-                ++i;
-            while (comp(data[pivotIdx], data[idx[j]]))
-                --j;
-            if (i <= j)
+            std::size_t value = out[root], child;
+            while ((child = 2 * root + 1) < k)
             {
-                std::swap(idx[i], idx[j]);
-                ++i;
-                --j;
+                if (child + 1 < k && ahead(out[child], out[child + 1]))
+                    ++child;
+                if (!ahead(value, out[child]))
+                    break;
+                out[root] = out[child];
+                root = child;
+            }
+            out[root] = value;
+        };
+
+        out.resize(k);
+        for (std::size_t i = 0; i < k; ++i)
+            out[i] = i;
+        for (std::size_t i = k / 2; i-- > 0;)
+            siftDown(i);
+        for (std::size_t i = k; i < data.size(); ++i)
+        {
+            if (ahead(i, out[0]))
+            {
+                out[0] = i;
+                siftDown(0);
             }
         }
-        return i;
+        pdqHeapSort(out.data(), out.data() + k, ahead);
     }
 
-    template <typename Data, typename Compare>
-    void quickSortIdxRec(std::vector<std::size_t> &idx, int low, int high,
-                         const std::vector<Data> &data, Compare comp)
+    // ---------------- parallel quicksort (fork-join) ----------------
+    // same partition steps, but each one hands the left side to the
+    // pool and keeps going on the right. Ranges under the cutoff are
+    // finished by the serial loop.
+    constexpr int QS_PARALLEL_CUTOFF = 1 << 14;
+
+    template <typename T, typename Compare>
+    void parallelPdqSortLoop(T *begin, T *end, Compare comp, int badAllowed, bool leftmost,
+                             TaskGroup &group)
     {
-        while (low < high)
+        while (end - begin >= QS_PARALLEL_CUTOFF)
         {
-            if (high - low < QS_INSERTION_THRESHOLD)
+            std::ptrdiff_t size = end - begin;
+            pdqChoosePivot(begin, end, comp);
+            if (!leftmost && !comp(*(begin - 1), *begin))
+            {
+                begin = pdqPartitionLeft(begin, end, comp) + 1;
+                continue;
+            }
+
+            T *pivotPos = pdqPartition(begin, end, comp).first;
+            if (pivotPos - begin < size / 8 || end - (pivotPos + 1) < size / 8)
             {
-                for (int i = low + 1; i <= high; ++i)
+                if (--badAllowed == 0)
                 {
-                    std::size_t key = idx[i];
-                    int j = i - 1;
-                    while (j >= low && comp(data[key], data[idx[j]]))
-                    {
-                        idx[j + 1] = idx[j];
-                        --j;
-                    }
-                    idx[j + 1] = key;
+                    pdqHeapSort(begin, end, comp);
+                    return;
                 }
-                return;
+                pdqBreakPatterns(begin, pivotPos, end);
             }
 
-            int mid = partitionIdx(idx, low, high, data, comp);
-            if (mid - low < high - mid)
+            group.run([begin, pivotPos, comp, badAllowed, leftmost, &group]()
+                      { parallelPdqSortLoop(begin, pivotPos, comp, badAllowed, leftmost, group); });
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+        pdqSortLoop(begin, end, comp, badAllowed, leftmost);
+    }
+
+    template <typename T, typename Compare>
+    void quickSort(std::vector<T> &arr, Compare comp, ThreadPool &pool)
+    {
+        if (arr.size() < static_cast<std::size_t>(QS_PARALLEL_CUTOFF) || pool.threadCount() == 1)
+        {
+            quickSort(arr, comp);
+            return;
+        }
+        TaskGroup group(pool);
+        parallelPdqSortLoop(arr.data(), arr.data() + arr.size(), comp, pdqLog2(arr.size()) + 1, true, group);
+        group.wait();
+    }
+
+    template <typename Data, typename Compare>
+    void quickSortIndices(std::vector<std::size_t> &idx,
+                          const std::vector<Data> &data,
+                          Compare comp,
+                          ThreadPool &pool)
+    {
+        quickSort(
+            idx, [&data, comp](std::size_t a, std::size_t b)
+            { return comp(data[a], data[b]); },
+            pool);
+    }
+
+    // ---------------- LSD radix sort for numeric views ----------------
+    // Numeric "Sort by" options don't need comparisons: every key is
+    // mapped to an unsigned integer with the same order, then
+    // (key, index) pairs are sorted one byte at a time. O(n) per pass,
+    // sequential reads, and bytes that are equal across all keys
+    // (high bytes of small ints, exponents of similar doubles) are skipped.
+    // Stable, so ties keep their current view order.
+
+    // flip the sign bit of positives, all bits of negatives.
+    // -0.0 folds to 0.0 so it ties with it, like operator< does.
+    // (NaN has no place in the comparator order either; don't store it.)
+    inline std::uint64_t orderedKey(double v)
+    {
+        if (v == 0.0)
+            v = 0.0;
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+    }
+
+    inline std::uint32_t orderedKey(int v)
+    {
+        return static_cast<std::uint32_t>(v) ^ 0x80000000u;
+    }
+
+    constexpr int RADIX_INSERTION_THRESHOLD = 64;
+
+    template <typename Data, typename KeyOf>
+    void radixSortIndices(std::vector<std::size_t> &idx,
+                          const std::vector<Data> &data,
+                          KeyOf keyOf)
+    {
+        using Key = decltype(orderedKey(keyOf(data[0])));
+        struct Item
+        {
+            Key key;
+            std::size_t index;
+        };
+        constexpr int BYTES = sizeof(Key);
+
+        std::size_t n = idx.size();
+        std::vector<Item> items(n);
+        for (std::size_t i = 0; i < n; ++i)
+            items[i] = {orderedKey(keyOf(data[idx[i]])), idx[i]};
+
+        if (n < static_cast<std::size_t>(RADIX_INSERTION_THRESHOLD))
+        {
+            for (std::size_t i = 1; i < n; ++i)
             {
-                quickSortIdxRec(idx, low, mid - 1, data, comp);
-                low = mid;
+                Item cur = items[i];
+                std::size_t j = i;
+                while (j > 0 && cur.key < items[j - 1].key)
+                {
+                    items[j] = items[j - 1];
+                    --j;
+                }
+                items[j] = cur;
             }
-            else
+        }
+        else
+        {
+            // all byte histograms in one read of the keys
+            std::vector<std::size_t> counts(BYTES * 256, 0);
+            for (const Item &it : items)
+                for (int b = 0; b < BYTES; ++b)
+                    ++counts[b * 256 + ((it.key >> (8 * b)) & 0xFF)];
+
+            std::vector<Item> tmp(n);
+            for (int b = 0; b < BYTES; ++b)
             {
-                quickSortIdxRec(idx, mid, high, data, comp);
-                high = mid - 1;
+                std::size_t *count = &counts[b * 256];
+                if (count[(items[0].key >> (8 * b)) & 0xFF] == n)
+                    continue; // every key has the same byte here
+
+                std::size_t offset = 0;
+                for (int d = 0; d < 256; ++d)
+                {
+                    std::size_t c = count[d];
+                    count[d] = offset;
+                    offset += c;
+                }
+                for (const Item &it : items)
+                    tmp[count[(it.key >> (8 * b)) & 0xFF]++] = it;
+                items.swap(tmp);
             }
         }
+
+        for (std::size_t i = 0; i < n; ++i)
+            idx[i] = items[i].index;
     }
 
+    // a table column is its own key
+    template <typename K>
+    void radixSortIndices(std::vector<std::size_t> &idx, const std::vector<K> &column)
+    {
+        radixSortIndices(idx, column, [](K v)
+                         { return v; });
+    }
+
+    // ---------------- sorted views ----------------
+    // the whole book in (record, row) order, the order repositionInView
+    // and the sorted dropFromView keep
     template <typename Data, typename Compare>
-    void quickSortIndices(std::vector<std::size_t> &idx,
-                          const std::vector<Data> &data,
-                          Compare comp)
+    void sortView(std::vector<std::size_t> &order, const std::vector<Data> &data, Compare comp, ThreadPool &pool)
+    {
+        quickSort(
+            order, [&data, comp](std::size_t a, std::size_t b)
+            { return viewBefore(data[a], a, data[b], b, comp); },
+            pool);
+    }
+
+    // numeric key: start from row order; the radix sort is stable
+    template <typename Data, typename KeyOf>
+    void radixSortView(std::vector<std::size_t> &order, const std::vector<Data> &data, KeyOf keyOf)
     {
-        if (!idx.empty())
-            quickSortIdxRec(idx, 0, static_cast<int>(idx.size()) - 1, data, comp);
+        order.resize(data.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        if (!order.empty())
+            radixSortIndices(order, data, keyOf);
     }
 }
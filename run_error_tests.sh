@@ -4,13 +4,14 @@ set -e
 echo "== Compiling =="
 
 # compile everything from src/ and tell the compiler to look in include/
-g++ -std=c++17 -Wall -Wextra -O2 \
+g++ -std=c++17 -Wall -Wextra -O2 -pthread \
   -Isrc -Iinclude \
   src/main.cpp \
   src/deposits.cpp \
   src/loans.cpp \
   src/credit.cpp \
   src/storage.cpp \
+  src/query.cpp \
   -o fincalc
 
 # make sure data folder exists
@@ -28,4 +29,21 @@ echo "== Running loans error test =="
 echo "== Running credits error test =="
 ./fincalc < tests/error_credits.txt
 
+echo "== Running duplicate-name delete test =="
+# two records share a name, one is deleted: the other must still be found by name
+out=$(./fincalc < tests/duplicate_names.txt)
+if grep -qi "not found" <<< "$out"; then
+  echo "❌ record lost its name after deleting a duplicate"
+  exit 1
+fi
+# and the search must actually print the surviving record of each book
+for found in "Found: Asha | Principal=100000 | Rate=10 | Years=5" \
+             "Found: Asha | Amt=10000 | Rate=8 | Months=12" \
+             "Found: Asha | Amount=5000 | Interest=2.5 | Months=12"; do
+  if ! grep -qF "$found" <<< "$out"; then
+    echo "❌ missing after deleting a duplicate: $found"
+    exit 1
+  fi
+done
+
 echo "✅ All scripted tests done."
@@ -0,0 +1,207 @@
+// src/batch.cpp
+// Streams a book through the calculators without loading it whole:
+//   batch [--rows N] <deposits|loans|credits|schedules> [in|-] [out|-]
+// Reads N rows at a time (default 65536; "-" or no path = stdin/stdout)
+// and writes one CSV line per record as each batch is done:
+//   deposits: name,amount,rate,months,maturity
+//   loans:    name,principal,rate,years,compound,emi
+//   credits:  name,amount,interest,months,monthly,total
+//   schedules: name,month,payment,interest,principal,balance
+//              (a loan book, one row per month of every loan)
+// Memory stays at one read block plus one batch of rows and results.
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+#include "storage.hpp"
+#include "thread_pool.hpp"
+
+static const std::size_t DEFAULT_BATCH_ROWS = 1 << 16;
+
+// CSV field: quoted only when it has to be
+static void appendField(std::string &out, const std::string &s)
+{
+    if (s.find_first_of(",\"") == std::string::npos)
+    {
+        out += s;
+        return;
+    }
+    out += '"';
+    for (char ch : s)
+    {
+        if (ch == '"')
+            out += '"';
+        out += ch;
+    }
+    out += '"';
+}
+
+// money and rates with two decimals, as the menus display them
+static void appendFixed(std::string &out, double v)
+{
+    char buf[64];
+    int n = std::snprintf(buf, sizeof buf, ",%.2f", v);
+    out.append(buf, n);
+}
+
+static void appendInt(std::string &out, int v)
+{
+    out += ',';
+    out += std::to_string(v);
+}
+
+// Reads batches of Table, calc(batch, results, line) appends one CSV
+// line per row; each batch goes out in a single write.
+template <typename Table, typename Calc>
+static int runBatches(const std::string &in, std::ostream &out, std::size_t rows,
+                      const char *header, Calc calc)
+{
+    Storage::BatchReader<Table> reader(rows);
+    if (!reader.open(in))
+    {
+        std::cerr << "cannot read " << in << "\n";
+        return 1;
+    }
+
+    Table batch;
+    std::string text = header;
+    std::size_t total = 0;
+    while (reader.next(batch))
+    {
+        calc(batch, text);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        text.clear();
+        total += batch.size();
+    }
+    out.write(text.data(), static_cast<std::streamsize>(text.size())); // header of an empty input
+    out.flush();
+
+    if (reader.failed() || !out)
+        return 1;
+    std::cerr << total << " rows\n";
+    return 0;
+}
+
+// Amortization schedules of every loan, formatted across the shared pool.
+static int runSchedules(const std::string &in, std::ostream &out, std::size_t rows)
+{
+    Storage::BatchReader<LoanTable> reader(rows);
+    if (!reader.open(in))
+    {
+        std::cerr << "cannot read " << in << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Loans::ScheduleWriter writer(out, ThreadPool::shared());
+    LoanTable batch;
+    std::size_t loans = 0;
+    while (reader.next(batch) && writer.write(batch))
+        loans += batch.size();
+    out.flush();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (reader.failed() || !out)
+        return 1;
+    std::cerr << loans << " loans, " << writer.rows() << " rows, "
+              << static_cast<long long>(secs > 0 ? writer.rows() / secs : 0) << " rows/s\n";
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    std::ios::sync_with_stdio(false);
+
+    std::size_t rows = DEFAULT_BATCH_ROWS;
+    int arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "--rows")
+    {
+        rows = static_cast<std::size_t>(std::strtoull(argv[2], nullptr, 10));
+        arg += 2;
+    }
+    if (argc - arg < 1 || argc - arg > 3 || rows == 0)
+    {
+        std::cerr << "usage: batch [--rows N] <deposits|loans|credits|schedules> [in|-] [out|-]\n";
+        return 1;
+    }
+
+    std::string which = argv[arg];
+    std::string in = argc - arg > 1 ? argv[arg + 1] : "-";
+    std::string outPath = argc - arg > 2 ? argv[arg + 2] : "-";
+
+    std::ofstream file;
+    if (outPath != "-")
+    {
+        file.open(outPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "cannot write " << outPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outPath == "-" ? std::cout : file;
+
+    std::vector<double> a, b;
+    if (which == "deposits")
+        return runBatches<DepositTable>(
+            in, out, rows, "name,amount,rate,months,maturity\n",
+            [&](const DepositTable &t, std::string &text)
+            {
+                Deposits::calcMaturity(t, a);
+                for (std::size_t i = 0; i < t.size(); ++i)
+                {
+                    appendField(text, t.name[i]);
+                    appendFixed(text, t.amount[i]);
+                    appendFixed(text, t.rate[i]);
+                    appendInt(text, t.months[i]);
+                    appendFixed(text, a[i]);
+                    text += '\n';
+                }
+            });
+    if (which == "loans")
+        return runBatches<LoanTable>(
+            in, out, rows, "name,principal,rate,years,compound,emi\n",
+            [&](const LoanTable &t, std::string &text)
+            {
+                Loans::calcCompound(t, a);
+                Loans::calcEMI(t, b);
+                for (std::size_t i = 0; i < t.size(); ++i)
+                {
+                    appendField(text, t.name[i]);
+                    appendFixed(text, t.principal[i]);
+                    appendFixed(text, t.rate[i]);
+                    appendInt(text, t.years[i]);
+                    appendFixed(text, a[i]);
+                    appendFixed(text, b[i]);
+                    text += '\n';
+                }
+            });
+    if (which == "credits")
+        return runBatches<CreditTable>(
+            in, out, rows, "name,amount,interest,months,monthly,total\n",
+            [&](const CreditTable &t, std::string &text)
+            {
+                Credits::calcMonthly(t, a);
+                Credits::calcTotal(t, b);
+                for (std::size_t i = 0; i < t.size(); ++i)
+                {
+                    appendField(text, t.name[i]);
+                    appendFixed(text, t.amount[i]);
+                    appendFixed(text, t.interest[i]);
+                    appendInt(text, t.months[i]);
+                    appendFixed(text, a[i]);
+                    appendFixed(text, b[i]);
+                    text += '\n';
+                }
+            });
+
+    if (which == "schedules")
+        return runSchedules(in, out, rows);
+
+    std::cerr << "unknown book: " << which << "\n";
+    return 1;
+}
@@ -5,12 +5,26 @@
 #include <chrono>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <random>
+#include <filesystem>
+#include <fstream>
+#include <map>
 
 #include "deposits.hpp"
 #include "loans.hpp"
 #include "credit.hpp"
 #include "utilities.hpp"
 #include "ds_hash.hpp"
+#include "ds_hash_chained.hpp"
+#include "ds_range.hpp"
+#include "ds_trie.hpp"
+#include "query.hpp"
+#include "aggregate.hpp"
+#include "storage.hpp"
+#include "rate_kernels.hpp"
+#include "scenarios.hpp"
+#include "montecarlo.hpp"
 
 // decide how many runs to average for a given N
 static int runs_for(int N)
@@ -70,6 +84,22 @@ static long long time_ms(F &&fn, int runs = 1)
     return total / runs / 1000; // micro -> ms
 }
 
+// same as time_ms but keeps sub-millisecond resolution
+template <typename F>
+static double time_us(F &&fn, int runs = 1)
+{
+    using clock = std::chrono::high_resolution_clock;
+    double total = 0;
+    for (int r = 0; r < runs; ++r)
+    {
+        auto t1 = clock::now();
+        fn();
+        auto t2 = clock::now();
+        total += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / 1000.0;
+    }
+    return total / runs;
+}
+
 // ---------- benchmark for DEPOSITS ----------
 static void benchDeposits(int N)
 {
@@ -339,11 +369,1488 @@ static void benchCredits(int N)
     std::cout << N << "," << ms_build << "," << ms_view << "," << ms_insert << "," << space_units << "\n";
 }
 
+// ---------- name lookup: chained vs flat StringIntMap ----------
+// N keys, N hit lookups in shuffled order + N misses.
+// CSV: N,chained_ns_per_get,flat_ns_per_get,speedup
+static void benchLookup(int N)
+{
+    std::vector<std::string> keys;
+    keys.reserve(N);
+    for (int i = 0; i < N; ++i)
+        keys.push_back("Loan_User_" + std::to_string(i));
+
+    // deterministic shuffle so both maps see the same access pattern
+    std::vector<std::size_t> order(N);
+    for (int i = 0; i < N; ++i)
+        order[i] = i;
+    unsigned long long seed = 88172645463325252ULL;
+    for (std::size_t i = order.size(); i > 1; --i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::swap(order[i - 1], order[seed % i]);
+    }
+
+    // queries are copied out in shuffled order so reading the query
+    // strings themselves stays sequential; only the map is random access
+    std::vector<std::string> hits;
+    hits.reserve(N);
+    for (std::size_t i : order)
+        hits.push_back(keys[i]);
+
+    std::vector<std::string> misses;
+    misses.reserve(N);
+    for (int i = 0; i < N; ++i)
+        misses.push_back("Nobody_" + std::to_string(i));
+
+    ChainedStringIntMap chained(101);
+    StringIntMap flat(101);
+    for (int i = 0; i < N; ++i)
+    {
+        chained.put(keys[i], i);
+        flat.put(keys[i], i);
+    }
+
+    int runs = runs_for(N);
+    std::size_t sink = 0;
+
+    auto lookups = [&](const auto &map)
+    {
+        std::size_t v;
+        for (const auto &k : hits)
+            if (map.get(k, v))
+                sink += v;
+        for (const auto &k : misses)
+            if (map.get(k, v))
+                sink += v;
+    };
+
+    lookups(chained); // warmup
+    lookups(flat);
+    double us_chained = time_us([&]()
+                                { lookups(chained); }, runs);
+    double us_flat = time_us([&]()
+                             { lookups(flat); }, runs);
+
+    double ops = 2.0 * N;
+    double ns_chained = us_chained * 1000.0 / ops;
+    double ns_flat = us_flat * 1000.0 / ops;
+
+    std::cout << N << "," << ns_chained << "," << ns_flat << ","
+              << (ns_flat > 0 ? ns_chained / ns_flat : 0.0) << "\n";
+    if (sink == 42)
+        std::cerr << ""; // keep the loops alive
+}
+
+// ---------- value indexes: chained vs Swiss HashMultiMap ----------
+// bulk put of N postings into a fresh map (what rebuildValueIndexes
+// does) then N shuffled gets, for two key shapes:
+//   unique  - every record its own amount (high cardinality)
+//   lowcard - 5 distinct rates, huge postings per key
+// CSV: N,shape,chained_put_ms,swiss_put_ms,put_speedup,chained_get_ms,swiss_get_ms,get_speedup
+template <typename KeyFn>
+static void benchMultiMapShape(int N, const char *shape, KeyFn keyOf)
+{
+    std::vector<double> keys(N);
+    for (int i = 0; i < N; ++i)
+        keys[i] = keyOf(i);
+
+    std::vector<double> queries(keys);
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+    for (std::size_t i = queries.size(); i > 1; --i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        std::swap(queries[i - 1], queries[seed % i]);
+    }
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    std::size_t sink = 0;
+
+    ChainedMultiMap<double> chained(101);
+    HashMultiMap<double> swiss(101);
+
+    double put_chained = time_us([&]()
+                                 {
+        chained = ChainedMultiMap<double>(101);
+        for (int i = 0; i < N; ++i)
+            chained.put(keys[i], i); }, runs) / 1000.0;
+    double put_swiss = time_us([&]()
+                               {
+        swiss = HashMultiMap<double>(101);
+        for (int i = 0; i < N; ++i)
+            swiss.put(keys[i], i); }, runs) / 1000.0;
+
+    double get_chained = time_us([&]()
+                                 {
+        for (double q : queries)
+            sink += chained.get(q).size(); }, runs) / 1000.0;
+    double get_swiss = time_us([&]()
+                               {
+        for (double q : queries)
+            sink += swiss.get(q).size(); }, runs) / 1000.0;
+
+    std::cout << N << "," << shape << ","
+              << put_chained << "," << put_swiss << ","
+              << (put_swiss > 0 ? put_chained / put_swiss : 0.0) << ","
+              << get_chained << "," << get_swiss << ","
+              << (get_swiss > 0 ? get_chained / get_swiss : 0.0) << "\n";
+    if (sink == 42)
+        std::cerr << ""; // keep the loops alive
+}
+
+static void benchMultiMap(int N)
+{
+    benchMultiMapShape(N, "unique", [](int i)
+                       { return 1000.0 + i * 0.01; });
+    benchMultiMapShape(N, "lowcard", [](int i)
+                       { return 7.5 + (i % 5); });
+}
+
+// ---------- value indexes: swap-and-pop deletes ----------
+// N postings, then N/2 deletes the way removeAt does them: erase the
+// row, rename the last row to it. "scan" finds each posting by walking
+// the key's list and erases it in place (the old HashMultiMap::erase);
+// "table" is HashMultiMap. Afterwards every key must hold exactly its
+// surviving rows, each once.
+// CSV: N,shape,scan_ms,table_ms,speedup
+template <typename KeyFn>
+static void benchDeletesShape(int N, const char *shape, KeyFn keyOf)
+{
+    std::vector<double> keys(N);
+    for (int i = 0; i < N; ++i)
+        keys[i] = keyOf(i);
+
+    // rows to delete, drawn while the book shrinks
+    std::vector<std::size_t> victims;
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+    for (std::size_t live = N; live > static_cast<std::size_t>(N) / 2; --live)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        victims.push_back(seed % live);
+    }
+
+    std::vector<double> book;
+    std::map<double, std::vector<std::size_t>> scan;
+    double scan_ms = time_us([&]()
+                             {
+        scan.clear();
+        book = keys;
+        for (int i = 0; i < N; ++i)
+            scan[keys[i]].push_back(i);
+        for (std::size_t idx : victims)
+        {
+            std::size_t last = book.size() - 1;
+            auto &gone = scan[book[idx]];
+            gone.erase(std::find(gone.begin(), gone.end(), idx));
+            if (idx != last)
+            {
+                auto &moved = scan[book[last]];
+                *std::find(moved.begin(), moved.end(), last) = idx;
+                book[idx] = book[last];
+            }
+            book.pop_back();
+        } }) / 1000.0;
+
+    HashMultiMap<double> table(101);
+    double table_ms = time_us([&]()
+                              {
+        table = HashMultiMap<double>(101);
+        book = keys;
+        table.build(book.begin(), book.end(), [](double k)
+                    { return k; });
+        for (std::size_t idx : victims)
+        {
+            std::size_t last = book.size() - 1;
+            table.erase(book[idx], idx);
+            if (idx != last)
+            {
+                table.replace(book[last], last, idx);
+                book[idx] = book[last];
+            }
+            book.pop_back();
+        } }) / 1000.0;
+
+    // same survivors, each under its key exactly once
+    bool ok = table.size() == book.size();
+    std::vector<char> seen(book.size(), 0);
+    for (const auto &entry : scan)
+    {
+        IndexSpan rows = table.get(entry.first);
+        ok = ok && rows.size() == entry.second.size();
+        for (std::size_t row : rows)
+        {
+            ok = ok && row < book.size() && book[row] == entry.first && !seen[row];
+            if (row < seen.size())
+                seen[row] = 1;
+        }
+    }
+    if (!ok)
+        std::cerr << "deletes: HashMultiMap postings wrong after deletes (" << shape << ")\n";
+
+    std::cout << N << "," << shape << "," << scan_ms << "," << table_ms << ","
+              << (table_ms > 0 ? scan_ms / table_ms : 0.0) << "\n";
+}
+
+static void benchDeletes(int N)
+{
+    benchDeletesShape(N, "unique", [](int i)
+                      { return 1000.0 + i * 0.01; });
+    benchDeletesShape(N, "lowcard", [](int i)
+                      { return 7.5 + (i % 5); });
+}
+
+// ---------- sorted view upkeep ----------
+// a loan view sorted by rate (5 distinct rates, N/5 loans on each) kept
+// sorted through updates (repositionInView; every other one changes
+// only the principal, so the entry stays in its run of equal rates) and
+// swap-and-pop deletes (dropFromView), at most 1000 of each, then
+// checked against the view sorted from scratch, by radix sort and by
+// sortView.
+// CSV: N,update_us_per_op,delete_us_per_op
+static void benchViews(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan(i));
+    auto rateOf = [](const Loan &l)
+    { return l.rate; };
+
+    std::vector<std::size_t> view;
+    Utilities::radixSortView(view, loans, rateOf);
+    std::size_t ops = std::min<std::size_t>(N / 10 + 1, 1000);
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+    auto next = [&seed]()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+
+    double update_us = time_us([&]()
+                               {
+        for (std::size_t k = 0; k < ops; ++k)
+        {
+            std::size_t idx = next() % loans.size();
+            Loan before = loans[idx];
+            if (k % 2)
+                loans[idx].rate = 7.5 + next() % 5;
+            else
+                loans[idx].principal += 1; // stays in its run of equal rates
+            Utilities::repositionInView(view, loans, idx, before, LoanBy::byRate);
+        } });
+
+    double delete_us = time_us([&]()
+                               {
+        for (std::size_t k = 0; k < ops && loans.size() > 1; ++k)
+        {
+            std::size_t idx = next() % loans.size(), last = loans.size() - 1;
+            loans[idx] = loans[last];
+            loans.pop_back();
+            Utilities::dropFromView(view, loans, idx, last, LoanBy::byRate);
+        } });
+
+    std::vector<std::size_t> fresh, sorted;
+    Utilities::radixSortView(fresh, loans, rateOf);
+    sorted = fresh;
+    Utilities::sortView(sorted, loans, LoanBy::byRate, ThreadPool::shared());
+    if (view != fresh || sorted != fresh)
+        std::cerr << "views: kept view differs from a fresh sort\n";
+
+    std::cout << N << "," << update_us / ops << "," << delete_us / ops << "\n";
+}
+
+// ---------- index rebuild: put loop vs bulk build ----------
+// the four loan indexes rebuilt from scratch, the way rebuildAll used
+// to (fresh 101-slot maps + n puts each) vs reserve-once build().
+// CSV: N,put_loop_ms,build_ms,speedup
+static void benchRebuild(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan(i));
+    for (int i = 0; i < N; ++i)
+        loans[i].principal += i * 0.01; // near-unique like real balances
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+
+    double ms_put = time_us([&]()
+                            {
+        StringIntMap nameIndex(101);
+        HashMultiMap<double> principalIndex(101);
+        HashMultiMap<double> rateIndex(101);
+        HashMultiMap<int> yearsIndex(101);
+        for (std::size_t i = 0; i < loans.size(); ++i)
+        {
+            nameIndex.put(loans[i].name, i);
+            principalIndex.put(loans[i].principal, i);
+            rateIndex.put(loans[i].rate, i);
+            yearsIndex.put(loans[i].years, i);
+        } }, runs) / 1000.0;
+
+    double ms_build = time_us([&]()
+                              {
+        StringIntMap nameIndex(101);
+        HashMultiMap<double> principalIndex(101);
+        HashMultiMap<double> rateIndex(101);
+        HashMultiMap<int> yearsIndex(101);
+        nameIndex.build(loans.begin(), loans.end(),
+                        [](const Loan &l) -> const std::string &
+                        { return l.name; });
+        principalIndex.build(loans.begin(), loans.end(),
+                             [](const Loan &l)
+                             { return l.principal; });
+        rateIndex.build(loans.begin(), loans.end(),
+                        [](const Loan &l)
+                        { return l.rate; });
+        yearsIndex.build(loans.begin(), loans.end(),
+                         [](const Loan &l)
+                         { return l.years; }); }, runs) / 1000.0;
+
+    std::cout << N << "," << ms_put << "," << ms_build << ","
+              << (ms_build > 0 ? ms_put / ms_build : 0.0) << "\n";
+}
+
+// ---------- parallel quicksort scaling ----------
+// the rebuild sort (records by name) and a view sort (indices by
+// principal) on pools of 1, 2, 4, 8 and 16 threads. Every run sorts
+// a fresh unsorted copy; copying is not timed.
+// CSV: N,threads,records_ms,view_ms,records_speedup,view_speedup
+static void benchParallelSort(int N)
+{
+    std::vector<Loan> base;
+    base.reserve(N);
+    for (int i = 0; i < N; ++i)
+        base.push_back(makeLoan((i * 7919) % N)); // scrambled names
+    std::vector<std::size_t> baseIdx(N);
+    for (int i = 0; i < N; ++i)
+        baseIdx[i] = i;
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    double records1 = 0, view1 = 0;
+
+    for (std::size_t threads : {1, 2, 4, 8, 16})
+    {
+        ThreadPool pool(threads);
+        double records_us = 0, view_us = 0;
+        for (int r = 0; r < runs; ++r)
+        {
+            std::vector<Loan> loans = base;
+            records_us += time_us([&]()
+                                  { Utilities::quickSort(loans, LoanBy::byName, pool); });
+            std::vector<std::size_t> idx = baseIdx;
+            view_us += time_us([&]()
+                               { Utilities::quickSortIndices(idx, base, LoanBy::byPrincipal, pool); });
+        }
+        double records_ms = records_us / runs / 1000.0;
+        double view_ms = view_us / runs / 1000.0;
+        if (threads == 1)
+        {
+            records1 = records_ms;
+            view1 = view_ms;
+        }
+        std::cout << N << "," << threads << "," << records_ms << "," << view_ms << ","
+                  << (records_ms > 0 ? records1 / records_ms : 0.0) << ","
+                  << (view_ms > 0 ? view1 / view_ms : 0.0) << "\n";
+    }
+}
+
+// ---------- radix vs comparison view sort ----------
+// numeric view sorts: index quicksort with the comparator vs the
+// key-extraction radix sort the menus use. Copying is not timed.
+// CSV: N,field,quicksort_ms,radix_ms,speedup
+template <typename Compare, typename KeyOf>
+static void benchRadixField(int N, const char *field, const std::vector<Loan> &loans,
+                            Compare comp, KeyOf keyOf)
+{
+    std::vector<std::size_t> base(N);
+    for (int i = 0; i < N; ++i)
+        base[i] = i;
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    double quick_us = 0, radix_us = 0;
+    for (int r = 0; r < runs; ++r)
+    {
+        std::vector<std::size_t> idx = base;
+        quick_us += time_us([&]()
+                            { Utilities::quickSortIndices(idx, loans, comp); });
+        idx = base;
+        radix_us += time_us([&]()
+                            { Utilities::radixSortIndices(idx, loans, keyOf); });
+    }
+    double quick_ms = quick_us / runs / 1000.0;
+    double radix_ms = radix_us / runs / 1000.0;
+    std::cout << N << "," << field << "," << quick_ms << "," << radix_ms << ","
+              << (radix_ms > 0 ? quick_ms / radix_ms : 0.0) << "\n";
+}
+
+static void benchRadix(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan((i * 7919) % N));
+
+    benchRadixField(N, "principal", loans, LoanBy::byPrincipal, [](const Loan &l)
+                    { return l.principal; });
+    benchRadixField(N, "years", loans, LoanBy::byYears, [](const Loan &l)
+                    { return l.years; });
+}
+
+// ---------- sort input shapes ----------
+// quickSort / quickSortIndices on the shapes that hurt a plain
+// middle-pivot quicksort. Every shape should stay O(n log n).
+// CSV: N,shape,view_ms,records_ms
+static double shapeKey(int shape, int i, int N, std::mt19937 &rng)
+{
+    switch (shape)
+    {
+    case 0:
+        return static_cast<double>(rng() % N); // random
+    case 1:
+        return i; // sorted
+    case 2:
+        return N - i; // reversed
+    case 3:
+        return 7.5 + (rng() % 4); // few distinct (like rate)
+    case 4:
+        return i < N / 2 ? i : N - i; // organ pipe
+    default:
+        return i + (rng() % 100 == 0 ? rng() % N : 0); // sorted, 1% moved
+    }
+}
+
+static void benchSortShapes(int N)
+{
+    const char *names[] = {"random", "sorted", "reversed", "few_distinct", "organ_pipe", "nearly_sorted"};
+    std::mt19937 rng(42);
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+
+    for (int shape = 0; shape < 6; ++shape)
+    {
+        std::vector<Loan> base(N);
+        for (int i = 0; i < N; ++i)
+        {
+            base[i].principal = shapeKey(shape, i, N, rng);
+            base[i].name = "Loan_" + std::to_string(static_cast<long long>(base[i].principal));
+        }
+
+        double view_us = 0, records_us = 0;
+        for (int r = 0; r < runs; ++r)
+        {
+            std::vector<std::size_t> idx(N);
+            for (int i = 0; i < N; ++i)
+                idx[i] = i;
+            view_us += time_us([&]()
+                               { Utilities::quickSortIndices(idx, base, LoanBy::byPrincipal); });
+            std::vector<Loan> loans = base;
+            records_us += time_us([&]()
+                                  { Utilities::quickSort(loans, LoanBy::byName); });
+        }
+        std::cout << N << "," << names[shape] << "," << view_us / runs / 1000.0 << ","
+                  << records_us / runs / 1000.0 << "\n";
+    }
+}
+
+// ---------- rows vs columns ----------
+// the same work on vector<Loan> and on a LoanTable: a numeric scan,
+// a view sort, an index build and the EMI calc.
+// CSV: N,op,aos_ms,soa_ms,speedup
+static void benchColumnsOp(int N, const char *op, double aos_us, double soa_us)
+{
+    std::cout << N << "," << op << "," << aos_us / 1000.0 << "," << soa_us / 1000.0 << ","
+              << (soa_us > 0 ? aos_us / soa_us : 0.0) << "\n";
+}
+
+static void benchColumns(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan((i * 7919) % N));
+    LoanTable table = LoanTable::from(loans);
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    volatile double sink = 0;
+    double aos_us, soa_us;
+
+    aos_us = time_us([&]()
+                     {
+        double sum = 0;
+        for (const auto &l : loans)
+            sum += l.principal;
+        sink = sum; }, runs);
+    soa_us = time_us([&]()
+                     {
+        double sum = 0;
+        for (double p : table.principal)
+            sum += p;
+        sink = sum; }, runs);
+    benchColumnsOp(N, "sum_principal", aos_us, soa_us);
+
+    std::vector<std::size_t> view(N);
+    aos_us = time_us([&]()
+                     {
+        for (int i = 0; i < N; ++i)
+            view[i] = i;
+        Utilities::radixSortIndices(view, loans, [](const Loan &l)
+                                    { return l.rate; }); }, runs);
+    soa_us = time_us([&]()
+                     {
+        for (int i = 0; i < N; ++i)
+            view[i] = i;
+        Utilities::radixSortIndices(view, table.rate); }, runs);
+    benchColumnsOp(N, "sort_rate", aos_us, soa_us);
+
+    aos_us = time_us([&]()
+                     {
+        HashMultiMap<double> index;
+        index.build(loans.begin(), loans.end(), [](const Loan &l)
+                    { return l.principal; }); }, runs);
+    soa_us = time_us([&]()
+                     {
+        HashMultiMap<double> index;
+        index.build(table.principal.begin(), table.principal.end(), [](double p)
+                    { return p; }); }, runs);
+    benchColumnsOp(N, "index_principal", aos_us, soa_us);
+
+    std::vector<double> emi(N);
+    aos_us = time_us([&]()
+                     {
+        for (int i = 0; i < N; ++i)
+            emi[i] = Loans::calcEMI(loans[i]); }, runs);
+    soa_us = time_us([&]()
+                     { Loans::calcEMI(table, emi); }, runs);
+    benchColumnsOp(N, "emi", aos_us, soa_us);
+    (void)sink;
+}
+
+// ---------- text vs columnar file loading ----------
+// N loans saved once as text and once as .col (temp dir), then loaded
+// back: text parse into records, .col into records and into a
+// LoanTable, and a bare MappedColumns::open.
+// CSV: N,text_load_ms,col_records_ms,col_table_ms,mmap_open_ms,text_bytes,col_bytes
+static void benchColumnFile(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan(i));
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string textPath = (dir / "fincalc_bench_loans.txt").string();
+    std::string colPath = (dir / "fincalc_bench_loans.col").string();
+    Storage::saveLoans(loans, textPath);
+    Storage::saveLoansBinary(LoanTable::from(loans), colPath);
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    std::vector<Loan> records;
+    LoanTable table;
+    Storage::MappedColumns mapped;
+
+    double text_us = time_us([&]()
+                             { Storage::loadLoans(records, textPath); }, runs);
+    double col_records_us = time_us([&]()
+                                    { Storage::loadLoans(records, colPath); }, runs);
+    double col_table_us = time_us([&]()
+                                  { Storage::loadLoans(table, colPath); }, runs);
+    double mmap_us = time_us([&]()
+                             { mapped.open(colPath, Storage::BookKind::Loans); }, runs);
+
+    std::cout << N << "," << text_us / 1000.0 << "," << col_records_us / 1000.0 << ","
+              << col_table_us / 1000.0 << "," << mmap_us / 1000.0 << ","
+              << std::filesystem::file_size(textPath) << "," << std::filesystem::file_size(colPath) << "\n";
+
+    mapped.close();
+    std::filesystem::remove(textPath);
+    std::filesystem::remove(colPath);
+}
+
+// ---------- text loader ----------
+// N-line loans.txt loaded by the old operator>> loop (kept here as the
+// baseline) and by Storage::loadLoans (mmap + from_chars), into
+// records and into a LoanTable.
+// CSV: N,ifstream_ms,fast_ms,speedup,fast_table_ms
+static void legacyLoadLoans(std::vector<Loan> &loans, const std::string &path)
+{
+    std::ifstream in(path);
+    loans.clear();
+    Loan l;
+    while (in >> l.name >> l.principal >> l.rate >> l.years)
+        loans.push_back(l);
+}
+
+static void benchLoader(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+    {
+        loans.push_back(makeLoan(i));
+        loans.back().rate += (i % 7) * 0.125; // some fractional rates
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / "fincalc_bench_loader.txt").string();
+    Storage::saveLoans(loans, path);
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    std::vector<Loan> records;
+    LoanTable table;
+    double legacy_us = time_us([&]()
+                               { legacyLoadLoans(records, path); }, runs);
+    std::size_t legacyRows = records.size();
+    double fast_us = time_us([&]()
+                             { Storage::loadLoans(records, path); }, runs);
+    double table_us = time_us([&]()
+                              { Storage::loadLoans(table, path); }, runs);
+    if (records.size() != legacyRows || table.size() != legacyRows)
+        std::cerr << "loader row count mismatch at N=" << N << "\n";
+
+    std::cout << N << "," << legacy_us / 1000.0 << "," << fast_us / 1000.0 << ","
+              << (fast_us > 0 ? legacy_us / fast_us : 0.0) << "," << table_us / 1000.0 << "\n";
+    std::filesystem::remove(path);
+}
+
+// ---------- parallel loader ----------
+// N-line loans.txt loaded on pools of 1, 2, 4 and 8 threads into
+// records and into a LoanTable, then the name index built from the
+// hashes the load left in LoadInfo vs hashing every name again.
+// Files under 2 x PARALLEL_LOAD_CHUNK are parsed in one piece.
+// CSV: N,threads,records_ms,table_ms,records_speedup,name_index_hashed_ms,name_index_plain_ms
+static void benchParallelLoader(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan(i));
+
+    std::string path = (std::filesystem::temp_directory_path() / "fincalc_bench_pload.txt").string();
+    Storage::saveLoans(loans, path);
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    double records1 = 0;
+    auto nameOf = [](const Loan &l) -> const std::string &
+    { return l.name; };
+
+    for (std::size_t threads : {1, 2, 4, 8})
+    {
+        ThreadPool pool(threads);
+        std::vector<Loan> records;
+        LoanTable table;
+        Storage::LoadInfo info;
+        double records_ms = time_us([&]()
+                                    { Storage::loadLoans(records, path, pool, &info); }, runs) / 1000.0;
+        double table_ms = time_us([&]()
+                                  { Storage::loadLoans(table, path, pool); }, runs) / 1000.0;
+        if (threads == 1)
+            records1 = records_ms;
+
+        StringIntMap index(101);
+        double hashed_ms = time_us([&]()
+                                   { index.build(records.begin(), records.end(), nameOf,
+                                                 info.nameHashes(records.size()), info.nameBytes); }, runs) / 1000.0;
+        double plain_ms = time_us([&]()
+                                  { index.build(records.begin(), records.end(), nameOf); }, runs) / 1000.0;
+
+        std::cout << N << "," << threads << "," << records_ms << "," << table_ms << ","
+                  << (records_ms > 0 ? records1 / records_ms : 0.0) << ","
+                  << hashed_ms << "," << plain_ms << "\n";
+    }
+    std::filesystem::remove(path);
+}
+
+// ---------- journal ----------
+// Cost of persisting one edit to an N-row book: rewriting the whole
+// file (the old save-on-exit) vs one synced journal entry, plus a full
+// compaction (snapshot written, fsynced and renamed in).
+// CSV: N,full_save_ms,journal_entry_us,compact_ms
+static void benchJournal(int N)
+{
+    std::vector<Loan> loans;
+    loans.reserve(N);
+    for (int i = 0; i < N; ++i)
+        loans.push_back(makeLoan(i));
+
+    std::string book = (std::filesystem::temp_directory_path() / "fincalc_bench_journal.txt").string();
+    Storage::saveLoans(loans, book);
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    double save_us = time_us([&]()
+                             { Storage::saveLoans(loans, book); }, runs);
+
+    Storage::Journal<Loan> journal(book);
+    journal.load(loans);
+    const int edits = 200;
+    double entry_us = time_us([&]()
+                              {
+        for (int e = 0; e < edits; ++e)
+        {
+            std::size_t idx = static_cast<std::size_t>(e) % loans.size();
+            loans[idx].rate += 0.25;
+            journal.update(idx, loans[idx]);
+        } }) / edits;
+    double compact_us = time_us([&]()
+                                {
+        journal.compact(loans);
+        journal.wait(); });
+
+    std::cout << N << "," << save_us / 1000.0 << "," << entry_us << "," << compact_us / 1000.0 << "\n";
+    for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::temp_directory_path()))
+        if (entry.path().filename().string().rfind("fincalc_bench_journal.txt", 0) == 0)
+            std::filesystem::remove(entry.path());
+}
+
+// ---------- growth kernels ----------
+// EMI and compound interest over N loans (terms 1-50 years): the
+// per-loan std::pow loops the column calcs used to run vs the batch
+// kernels, plus the worst growth-factor distance from std::pow.
+// CSV: N,lanes,pow_emi_ms,kernel_emi_ms,emi_speedup,pow_compound_ms,kernel_compound_ms,compound_speedup,max_growth_ulp
+static long long ulpDistance(double a, double b)
+{
+    long long x, y;
+    std::memcpy(&x, &a, sizeof x);
+    std::memcpy(&y, &b, sizeof y);
+    return x > y ? x - y : y - x;
+}
+
+static void benchKernels(int N)
+{
+    LoanTable table;
+    table.reserve(N);
+    for (int i = 0; i < N; ++i)
+    {
+        Loan l = makeLoan(i);
+        l.rate = 0.5 + (i % 2951) / 100.0;
+        l.years = 1 + (i % 50);
+        table.push(l);
+    }
+
+    int runs = N >= 1000000 ? 1 : runs_for(N);
+    std::vector<double> out(N), ref(N);
+
+    double pow_emi_us = time_us([&]()
+                                {
+        for (int i = 0; i < N; ++i)
+        {
+            double monthlyRate = table.rate[i] / (12 * 100);
+            double growth = std::pow(1 + monthlyRate, table.years[i] * 12);
+            ref[i] = (table.principal[i] * monthlyRate * growth) / (growth - 1);
+        } }, runs);
+    double kernel_emi_us = time_us([&]()
+                                   { Loans::calcEMI(table, out); }, runs);
+    double pow_compound_us = time_us([&]()
+                                     {
+        for (int i = 0; i < N; ++i)
+            ref[i] = table.principal[i] * (std::pow(1 + table.rate[i] / 100.0, table.years[i]) - 1); }, runs);
+    double kernel_compound_us = time_us([&]()
+                                        { Loans::calcCompound(table, out); }, runs);
+
+    RateKernels::growth(table.rate.data(), 12 * 100, table.years.data(), 12, N, out.data());
+    long long worst = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        long long d = ulpDistance(out[i], std::pow(1 + table.rate[i] / (12 * 100), table.years[i] * 12));
+        if (d > worst)
+            worst = d;
+    }
+
+    std::cout << N << "," << RateKernels::LANES << ","
+              << pow_emi_us / 1000.0 << "," << kernel_emi_us / 1000.0 << ","
+              << (kernel_emi_us > 0 ? pow_emi_us / kernel_emi_us : 0.0) << ","
+              << pow_compound_us / 1000.0 << "," << kernel_compound_us / 1000.0 << ","
+              << (kernel_compound_us > 0 ? pow_compound_us / kernel_compound_us : 0.0) << ","
+              << worst << "\n";
+}
+
+// ---------- amortization schedules ----------
+// Schedules of N loans (1-30 years) on pools of 1, 2, 4 and 8 threads:
+// filled into one ScheduleRow buffer, and streamed as CSV to /dev/null.
+// CSV: N,threads,rows,buffer_ms,buffer_rows_per_s,csv_ms,csv_rows_per_s
+static void benchSchedule(int N)
+{
+    LoanTable table;
+    table.reserve(N);
+    for (int i = 0; i < N; ++i)
+    {
+        Loan l = makeLoan(i);
+        l.years = 1 + (i % 30);
+        table.push(l);
+    }
+
+    std::size_t rows = Loans::scheduleRows(table, 0, table.size());
+    std::vector<ScheduleRow> buffer(rows);
+    std::ofstream sink("/dev/null", std::ios::binary);
+    int runs = N >= 100000 ? 1 : runs_for(N);
+
+    for (std::size_t threads : {1, 2, 4, 8})
+    {
+        ThreadPool pool(threads);
+        double buffer_us = time_us([&]()
+                                   { Loans::schedules(table, 0, table.size(), buffer.data(), pool); }, runs);
+        double csv_us = time_us([&]()
+                                {
+            Loans::ScheduleWriter writer(sink, pool);
+            writer.write(table); }, runs);
+
+        std::cout << N << "," << threads << "," << rows << "," << buffer_us / 1000.0 << ","
+                  << (buffer_us > 0 ? rows / (buffer_us / 1e6) : 0.0) << "," << csv_us / 1000.0 << ","
+                  << (csv_us > 0 ? rows / (csv_us / 1e6) : 0.0) << "\n";
+    }
+}
+
+// principal between lo and hi over N loans: the ordered RangeIndex against
+// a full scan, 1000 random ranges ~1% of the principal spread wide; the
+// hit counts are checked against the scan, and again after N/10 edits
+// CSV: N,build_ms,range_us_per_query,scan_us_per_query,speedup,avg_hits
+static void benchRange(int N)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> amount(10000, 1000000);
+    std::vector<Loan> loans(N);
+    for (int i = 0; i < N; ++i)
+    {
+        loans[i] = makeLoan(i);
+        loans[i].principal = std::round(amount(rng));
+    }
+
+    RangeIndex<double> index;
+    double build_us = time_us([&]()
+                              { index.build(loans, [](const Loan &l)
+                                            { return l.principal; }); });
+
+    const int queries = 1000;
+    std::vector<std::pair<double, double>> ranges(queries);
+    for (auto &r : ranges)
+    {
+        r.first = amount(rng);
+        r.second = r.first + 10000;
+    }
+
+    auto scan = [&](double lo, double hi)
+    {
+        std::size_t n = 0;
+        for (const Loan &l : loans)
+            n += l.principal >= lo && l.principal <= hi;
+        return n;
+    };
+    auto check = [&]()
+    {
+        for (int q = 0; q < 50; ++q)
+            if (index.count(ranges[q].first, ranges[q].second) != scan(ranges[q].first, ranges[q].second))
+            {
+                std::cerr << "range index disagrees with the scan\n";
+                std::exit(1);
+            }
+    };
+
+    check();
+    std::vector<IndexSpan> spans;
+    volatile std::size_t sink = 0;
+    std::size_t hits = 0;
+    double range_us = time_us([&]()
+                              {
+        hits = 0;
+        for (auto &r : ranges)
+        {
+            index.range(r.first, r.second, spans);
+            for (const IndexSpan &span : spans)
+                for (std::size_t idx : span)
+                    hits += idx & 1;
+        }
+        sink = sink + hits; });
+    int scanQueries = N >= 1000000 ? 20 : queries;
+    double scan_us = time_us([&]()
+                             {
+        for (int q = 0; q < scanQueries; ++q)
+            sink = sink + scan(ranges[q].first, ranges[q].second); }) /
+                     scanQueries * queries;
+
+    // edits: what reindexAt does on an update
+    for (int e = 0; e < N / 10; ++e)
+    {
+        std::size_t i = rng() % N;
+        index.erase(loans[i].principal, i);
+        loans[i].principal = std::round(amount(rng));
+        index.put(loans[i].principal, i);
+    }
+    check();
+
+    std::size_t total = 0;
+    for (auto &r : ranges)
+        total += index.count(r.first, r.second);
+    std::cout << N << "," << build_us / 1000.0 << "," << range_us / queries << "," << scan_us / queries << ","
+              << (range_us > 0 ? scan_us / range_us : 0.0) << "," << static_cast<double>(total) / queries << "\n";
+}
+
+// partial-name search over N loans with made-up names: RadixTree prefixes
+// and TrigramIndex substrings against a scan, 1000 queries each. Hit
+// counts are checked against the scan, and again after N/10 swap-and-pop
+// deletes and N/10 adds
+// CSV: N,build_ms,prefix_us,prefix_scan_us,contains_us,contains_scan_us,avg_prefix_hits,avg_contains_hits
+static void benchNames(int N)
+{
+    static const char *syllables[] = {"an", "ra", "vi", "ka", "me", "na", "sh", "ja", "ya", "li",
+                                      "pr", "ak", "de", "su", "ri", "th", "mo", "ha", "ni", "ta"};
+    std::mt19937 rng(7);
+    auto makeName = [&]()
+    {
+        std::string name;
+        for (int part = 0; part < 2; ++part)
+        {
+            if (part)
+                name += ' ';
+            int n = 2 + rng() % 3;
+            for (int k = 0; k < n; ++k)
+                name += syllables[rng() % 20];
+            name[name.size() - 2 * n] = static_cast<char>(name[name.size() - 2 * n] - 'a' + 'A');
+        }
+        return name;
+    };
+    std::vector<Loan> loans(N);
+    for (int i = 0; i < N; ++i)
+    {
+        loans[i] = makeLoan(i);
+        loans[i].name = makeName();
+    }
+    auto nameOf = [](const Loan &l) -> const std::string &
+    { return l.name; };
+
+    RadixTree tree;
+    TrigramIndex grams;
+    double build_us = time_us([&]()
+                              {
+        std::vector<std::size_t> byName(loans.size());
+        for (std::size_t i = 0; i < byName.size(); ++i)
+            byName[i] = i;
+        Utilities::quickSortIndices(byName, loans, LoanBy::byName, ThreadPool::shared());
+        tree.build(loans, byName, nameOf);
+        grams.build(loans, nameOf); });
+
+    const int queries = 1000;
+    std::vector<std::string> prefixes(queries), parts(queries);
+    for (int q = 0; q < queries; ++q)
+    {
+        const std::string &name = loans[rng() % N].name;
+        prefixes[q] = name.substr(0, 4);
+        parts[q] = name.substr(2, 4);
+    }
+
+    std::vector<std::size_t> hits;
+    auto scanCount = [&](const std::string &part, bool prefix)
+    {
+        std::size_t n = 0;
+        for (const Loan &l : loans)
+            n += prefix ? l.name.compare(0, part.size(), part) == 0 : l.name.find(part) != std::string::npos;
+        return n;
+    };
+    auto check = [&]()
+    {
+        for (int q = 0; q < 50; ++q)
+        {
+            tree.withPrefix(prefixes[q], hits);
+            std::size_t byTree = hits.size();
+            grams.withSubstring(parts[q], loans, nameOf, hits);
+            if (byTree != scanCount(prefixes[q], true) || hits.size() != scanCount(parts[q], false))
+            {
+                std::cerr << "name search disagrees with the scan\n";
+                std::exit(1);
+            }
+        }
+    };
+    check();
+
+    volatile std::size_t sink = 0;
+    std::size_t prefixHits = 0, containsHits = 0;
+    double prefix_us = time_us([&]()
+                               {
+        prefixHits = 0;
+        for (auto &p : prefixes)
+        {
+            tree.withPrefix(p, hits);
+            prefixHits += hits.size();
+        } });
+    double contains_us = time_us([&]()
+                                 {
+        containsHits = 0;
+        for (auto &p : parts)
+        {
+            grams.withSubstring(p, loans, nameOf, hits);
+            containsHits += hits.size();
+        } });
+    int scanQueries = N >= 1000000 ? 10 : 100;
+    double prefix_scan_us = time_us([&]()
+                                    {
+        for (int q = 0; q < scanQueries; ++q)
+            sink = sink + scanCount(prefixes[q], true); }) /
+                            scanQueries;
+    double contains_scan_us = time_us([&]()
+                                      {
+        for (int q = 0; q < scanQueries; ++q)
+            sink = sink + scanCount(parts[q], false); }) /
+                              scanQueries;
+
+    // edits the way removeAt and the add menu do them
+    for (int e = 0; e < N / 10; ++e)
+    {
+        std::size_t idx = rng() % loans.size(), last = loans.size() - 1;
+        tree.erase(loans[idx].name, idx);
+        grams.erase(loans[idx].name, idx);
+        if (idx != last)
+        {
+            tree.replace(loans[last].name, last, idx);
+            grams.replace(loans[last].name, last, idx);
+            loans[idx] = std::move(loans[last]);
+        }
+        loans.pop_back();
+
+        Loan l = makeLoan(e);
+        l.name = makeName();
+        loans.push_back(l);
+        tree.put(l.name, loans.size() - 1);
+        grams.put(l.name, loans.size() - 1);
+    }
+    check();
+
+    std::cout << N << "," << build_us / 1000.0 << "," << prefix_us / queries << "," << prefix_scan_us << ","
+              << contains_us / queries << "," << contains_scan_us << ","
+              << static_cast<double>(prefixHits) / queries << "," << static_cast<double>(containsHits) / queries << "\n";
+}
+
+// filters over N deposits: Query::run on bitmap indexes for rate and
+// months and a RangeIndex for amount, against a full scan. Each filter's
+// hit count is checked against the scan, and again after N/10 updates
+// CSV: N,build_ms,filter,hits,query_ms,scan_ms,speedup
+static void benchQuery(int N)
+{
+    static const double rates[] = {5.0, 5.5, 6.0, 6.5, 7.0, 7.5, 8.0, 8.5, 9.0, 9.5};
+    static const int tenures[] = {3, 6, 9, 12, 18, 24, 36, 48, 60};
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> amount(1000, 1000000);
+    auto randomize = [&](Deposit &d)
+    {
+        d.amount = std::round(amount(rng));
+        d.rate = rates[rng() % 10];
+        d.months = tenures[rng() % 9];
+    };
+    std::vector<Deposit> deps(N);
+    for (int i = 0; i < N; ++i)
+    {
+        deps[i] = makeDeposit(i);
+        randomize(deps[i]);
+    }
+
+    BitmapIndex<double> rateBits;
+    BitmapIndex<int> monthsBits;
+    RangeIndex<double> amountRange;
+    double build_us = time_us([&]()
+                              {
+        rateBits.build(deps, [](const Deposit &d)
+                       { return d.rate; });
+        monthsBits.build(deps, [](const Deposit &d)
+                         { return d.months; });
+        amountRange.build(deps, [](const Deposit &d)
+                          { return d.amount; }); });
+
+    std::vector<Query::Field> fields(3);
+    fields[0].name = "amount";
+    fields[0].doubleRange = &amountRange;
+    fields[0].valueOf = [&](std::size_t i)
+    { return deps[i].amount; };
+    fields[1].name = "rate";
+    fields[1].doubleBits = &rateBits;
+    fields[2].name = "months";
+    fields[2].intBits = &monthsBits;
+
+    const char *filters[] = {"months <= 12 AND rate >= 7.5 AND amount > 10000",
+                             "months = 24 AND rate = 6.5",
+                             "rate >= 9 AND amount < 50000",
+                             "months > 36 AND rate < 6 AND amount >= 500000 AND amount < 510000"};
+    std::vector<std::vector<Query::Condition>> parsed(4);
+    std::string error;
+    for (int f = 0; f < 4; ++f)
+        if (!Query::parse(filters[f], parsed[f], error))
+        {
+            std::cerr << filters[f] << ": " << error << "\n";
+            std::exit(1);
+        }
+
+    auto scan = [&](const std::vector<Query::Condition> &conditions)
+    {
+        std::vector<int> column(conditions.size()); // 0 amount, 1 rate, 2 months
+        for (std::size_t k = 0; k < conditions.size(); ++k)
+            column[k] = conditions[k].field == "amount" ? 0 : conditions[k].field == "rate" ? 1
+                                                                                           : 2;
+        std::size_t n = 0;
+        for (const Deposit &d : deps)
+        {
+            bool ok = true;
+            for (std::size_t k = 0; k < conditions.size(); ++k)
+            {
+                const Query::Condition &c = conditions[k];
+                double v = column[k] == 0 ? d.amount : column[k] == 1 ? d.rate
+                                                                      : d.months;
+                switch (c.op)
+                {
+                case Query::Op::Less:
+                    ok = ok && v < c.value;
+                    break;
+                case Query::Op::LessEq:
+                    ok = ok && v <= c.value;
+                    break;
+                case Query::Op::Equal:
+                    ok = ok && v == c.value;
+                    break;
+                case Query::Op::GreaterEq:
+                    ok = ok && v >= c.value;
+                    break;
+                case Query::Op::Greater:
+                    ok = ok && v > c.value;
+                    break;
+                }
+            }
+            n += ok;
+        }
+        return n;
+    };
+    std::vector<std::size_t> rows;
+    auto check = [&]()
+    {
+        for (int f = 0; f < 4; ++f)
+            if (!Query::run(fields, parsed[f], rows, error) || rows.size() != scan(parsed[f]))
+            {
+                std::cerr << "filter disagrees with the scan: " << filters[f] << "\n";
+                std::exit(1);
+            }
+    };
+
+    // updates the way reindexAt does them
+    check();
+    for (int e = 0; e < N / 10; ++e)
+    {
+        std::size_t i = rng() % N;
+        Deposit before = deps[i];
+        randomize(deps[i]);
+        rateBits.erase(before.rate, i);
+        rateBits.put(deps[i].rate, i);
+        monthsBits.erase(before.months, i);
+        monthsBits.put(deps[i].months, i);
+        amountRange.erase(before.amount, i);
+        amountRange.put(deps[i].amount, i);
+    }
+    check();
+
+    volatile std::size_t sink = 0;
+    int runs = runs_for(N);
+    for (int f = 0; f < 4; ++f)
+    {
+        double query_us = time_us([&]()
+                                  {
+            Query::run(fields, parsed[f], rows, error);
+            sink = sink + rows.size(); }, runs);
+        double scan_us = time_us([&]()
+                                 { sink = sink + scan(parsed[f]); }, N >= 1000000 ? 1 : runs);
+        std::cout << N << "," << build_us / 1000.0 << ",\"" << filters[f] << "\"," << rows.size() << ","
+                  << query_us / 1000.0 << "," << scan_us / 1000.0 << ","
+                  << (query_us > 0 ? scan_us / query_us : 0.0) << "\n";
+    }
+}
+
+// aggregates over N credits: Aggregate::over on the amount column against
+// a loop over the records, and amount grouped by months with
+// Aggregate::groupBy against a std::map. RunningTotals then take N/10
+// updates and N/10 deletes and are checked against a fresh groupBy
+// CSV: N,over_ms,record_loop_ms,group_ms,map_group_ms,running_read_ns,max_rel_err
+static void benchAggregate(int N)
+{
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> amount(500, 50000);
+    std::vector<CreditRecord> credits(N);
+    for (int i = 0; i < N; ++i)
+    {
+        credits[i] = makeCredit(i);
+        credits[i].amount = std::round(amount(rng));
+        credits[i].months = 3 + rng() % 58;
+    }
+    CreditTable table = CreditTable::from(credits);
+
+    int runs = runs_for(N);
+    volatile double sink = 0;
+    Summary byColumn, byRecord;
+    double over_us = time_us([&]()
+                             { byColumn = Aggregate::over(table.amount); sink = sink + byColumn.sum; }, runs);
+    double record_us = time_us([&]()
+                               {
+        byRecord = Summary();
+        for (const CreditRecord &c : credits)
+            byRecord.add(c.amount);
+        sink = sink + byRecord.sum; }, runs);
+    if (byColumn.count != byRecord.count || byColumn.min != byRecord.min || byColumn.max != byRecord.max ||
+        std::fabs(byColumn.sum - byRecord.sum) > 1e-9 * std::fabs(byRecord.sum))
+    {
+        std::cerr << "column aggregate disagrees with the record loop\n";
+        std::exit(1);
+    }
+
+    std::vector<Aggregate::Group<int>> groups;
+    double group_us = time_us([&]()
+                              { Aggregate::groupBy(table.months, table.amount, groups); }, runs);
+    std::map<int, Summary> byMap;
+    double map_us = time_us([&]()
+                            {
+        byMap.clear();
+        for (const CreditRecord &c : credits)
+            byMap[c.months].add(c.amount); }, runs);
+    if (groups.size() != byMap.size())
+    {
+        std::cerr << "groupBy disagrees with std::map\n";
+        std::exit(1);
+    }
+
+    // running totals through edits the way reindexAt and removeAt make them
+    RunningTotals<int> totals;
+    totals.build(credits, [](const CreditRecord &c)
+                 { return c.months; },
+                 [](const CreditRecord &c)
+                 { return c.amount; });
+    for (int e = 0; e < N / 10; ++e)
+    {
+        std::size_t i = rng() % credits.size();
+        totals.remove(credits[i].months, credits[i].amount);
+        credits[i].amount = std::round(amount(rng));
+        credits[i].months = 3 + rng() % 58;
+        totals.add(credits[i].months, credits[i].amount);
+
+        std::size_t gone = rng() % credits.size();
+        totals.remove(credits[gone].months, credits[gone].amount);
+        credits[gone] = std::move(credits.back());
+        credits.pop_back();
+    }
+    table = CreditTable::from(credits);
+    Aggregate::groupBy(table.months, table.amount, groups);
+    double maxRelErr = 0;
+    bool same = groups.size() == totals.groups() && totals.count() == credits.size();
+    for (std::size_t g = 0; same && g < groups.size(); ++g)
+    {
+        same = groups[g].key == totals.key(g) && groups[g].summary.count == totals.count(g);
+        maxRelErr = std::max(maxRelErr, std::fabs(totals.sum(g) - groups[g].summary.sum) / groups[g].summary.sum);
+    }
+    if (!same)
+    {
+        std::cerr << "running totals disagree with groupBy\n";
+        std::exit(1);
+    }
+
+    const int reads = 1000000;
+    double read_us = time_us([&]()
+                             {
+        double s = 0;
+        for (int r = 0; r < reads; ++r)
+            s += totals.mean(static_cast<std::size_t>(r) % totals.groups());
+        sink = sink + s; });
+
+    std::cout << N << "," << over_us / 1000.0 << "," << record_us / 1000.0 << "," << group_us / 1000.0 << ","
+              << map_us / 1000.0 << "," << read_us * 1000.0 / reads << "," << maxRelErr << "\n";
+}
+
+// the View of N loans written to /dev/null: one stream insertion per
+// field (the old displayAll) against rows formatted into one buffer and
+// written a megabyte at a time; then the top 20 by principal with
+// topKIndices against a full quickSortIndices, checked to agree
+// CSV: N,k,stream_ms,buffer_ms,display_speedup,sort_ms,topk_ms,topk_speedup
+static void benchDisplay(int N)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> amount(10000, 1000000);
+    std::vector<Loan> loans(N);
+    for (int i = 0; i < N; ++i)
+    {
+        loans[i] = makeLoan(i);
+        loans[i].principal = std::round(amount(rng));
+    }
+    std::vector<std::size_t> order(N);
+    for (int i = 0; i < N; ++i)
+        order[i] = i;
+
+    std::ofstream sinkFile("/dev/null");
+    int runs = runs_for(N);
+    double stream_us = time_us([&]()
+                               {
+        for (std::size_t idx : order)
+        {
+            const Loan &l = loans[idx];
+            sinkFile << l.name
+                     << " | Principal=" << l.principal
+                     << " | Rate=" << l.rate
+                     << " | Years=" << l.years << "\n";
+        }
+        sinkFile.flush(); }, runs);
+    std::string buffer;
+    double buffer_us = time_us([&]()
+                               {
+        buffer.clear();
+        for (std::size_t idx : order)
+        {
+            const Loan &l = loans[idx];
+            buffer += l.name;
+            buffer += " | Principal=";
+            Utilities::appendNumber(buffer, l.principal);
+            buffer += " | Rate=";
+            Utilities::appendNumber(buffer, l.rate);
+            buffer += " | Years=";
+            Utilities::appendNumber(buffer, l.years);
+            buffer += '\n';
+            if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+            {
+                sinkFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+        sinkFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        sinkFile.flush(); }, runs);
+
+    const std::size_t k = 20;
+    auto largest = [](const Loan &a, const Loan &b)
+    { return LoanBy::byPrincipal(b, a); };
+    std::vector<std::size_t> sorted, top;
+    double sort_us = time_us([&]()
+                             {
+        sorted = order;
+        Utilities::quickSortIndices(sorted, loans, largest); }, runs);
+    double topk_us = time_us([&]()
+                             { Utilities::topKIndices(top, loans, k, largest); }, runs);
+    for (std::size_t i = 0; i < std::min<std::size_t>(k, sorted.size()); ++i)
+        if (loans[top[i]].principal != loans[sorted[i]].principal)
+        {
+            std::cerr << "top K disagrees with the sort\n";
+            std::exit(1);
+        }
+
+    std::cout << N << "," << k << "," << stream_us / 1000.0 << "," << buffer_us / 1000.0 << ","
+              << (buffer_us > 0 ? stream_us / buffer_us : 0.0) << "," << sort_us / 1000.0 << ","
+              << topk_us / 1000.0 << "," << (topk_us > 0 ? sort_us / topk_us : 0.0) << "\n";
+}
+
+// N loans and N deposits under a 9 x 3 shock grid: the tiled engine on
+// pools of 1..8 threads against one pass over the book per scenario with
+// std::pow per record
+// CSV: N,scenarios,threads,tiled_ms,per_record_ms,speedup,evals_per_s
+static void benchScenarios(int N)
+{
+    LoanTable loans;
+    DepositTable deposits;
+    loans.reserve(N);
+    deposits.reserve(N);
+    for (int i = 0; i < N; ++i)
+    {
+        Loan l = makeLoan(i);
+        l.years = 1 + (i % 30);
+        loans.push(l);
+        deposits.push(makeDeposit(i));
+    }
+    std::vector<Scenario> grid = Scenarios::grid({-2, -1, -0.5, -0.25, 0, 0.25, 0.5, 1, 2}, {-12, 0, 12});
+    int runs = N >= 100000 ? 1 : runs_for(N);
+
+    volatile double sink = 0;
+    double per_record_us = time_us([&]()
+                                   {
+        for (const Scenario &sc : grid)
+        {
+            double emi = 0, maturity = 0;
+            for (std::size_t i = 0; i < loans.size(); ++i)
+            {
+                int months = loans.years[i] * 12 + sc.termShift;
+                if (months <= 0)
+                    continue;
+                double m = (loans.rate[i] + sc.rateShift) / (12 * 100);
+                double g = std::pow(1 + m, months);
+                emi += m != 0 ? loans.principal[i] * m * g / (g - 1) : loans.principal[i] / months;
+            }
+            for (std::size_t i = 0; i < deposits.size(); ++i)
+            {
+                int months = deposits.months[i] + sc.termShift;
+                if (months > 0)
+                    maturity += deposits.amount[i] + deposits.amount[i] * (deposits.rate[i] + sc.rateShift) * (months / 12.0) / 100.0;
+            }
+            sink = sink + emi + maturity;
+        } }, runs);
+
+    double evals = 2.0 * N * grid.size();
+    for (std::size_t threads : {1, 2, 4, 8})
+    {
+        ThreadPool pool(threads);
+        double tiled_us = time_us([&]()
+                                  { sink = sink + Scenarios::run(loans, deposits, grid, pool)[0].emi; }, runs);
+        std::cout << N << "," << grid.size() << "," << threads << "," << tiled_us / 1000.0 << ","
+                  << per_record_us / 1000.0 << "," << (tiled_us > 0 ? per_record_us / tiled_us : 0.0) << ","
+                  << (tiled_us > 0 ? evals / (tiled_us / 1e6) : 0.0) << "\n";
+    }
+}
+
+// N Vasicek paths over 100K loans (1-30 years) and 100K deposits on pools
+// of 1..8 threads. Paths 0 and 1 are checked against a record-by-record
+// valuation, and every pool's results against the one-thread run
+// CSV: paths,records,threads,book_ms,sim_ms,paths_per_s,paths_per_s_per_core,max_rel_err,same_as_1_thread
+static void benchMonteCarlo(int N)
+{
+    const int records = 100000;
+    LoanTable loans;
+    DepositTable deposits;
+    loans.reserve(records);
+    deposits.reserve(records);
+    for (int i = 0; i < records; ++i)
+    {
+        Loan l = makeLoan(i);
+        l.years = 1 + (i % 30);
+        loans.push(l);
+        deposits.push(makeDeposit(i));
+    }
+
+    RateModel model;
+    const std::uint64_t seed = 2024;
+    MonteCarlo::Book book;
+    double book_us = time_us([&]()
+                             { book = MonteCarlo::Book::from(loans, deposits); });
+
+    double maxRelErr = 0;
+    std::vector<double> rate(book.months + 1);
+    std::vector<PathValue> check(2);
+    ThreadPool single(1);
+    MonteCarlo::simulate(book, model, seed, 0, check.size(), check.data(), single);
+    for (std::size_t p = 0; p < check.size(); ++p)
+    {
+        MonteCarlo::path(model, seed, p, book.months, rate.data());
+        PathValue ref = MonteCarlo::valuePath(loans, deposits, model, rate.data());
+        for (double PathValue::*f : {&PathValue::loanValue, &PathValue::depositMaturity, &PathValue::depositValue})
+            maxRelErr = std::max(maxRelErr, std::fabs(check[p].*f - ref.*f) / std::fabs(ref.*f));
+    }
+
+    std::vector<PathValue> first(N), out(N);
+    for (std::size_t threads : {1, 2, 4, 8})
+    {
+        ThreadPool pool(threads);
+        std::vector<PathValue> &into = threads == 1 ? first : out;
+        double sim_us = time_us([&]()
+                                { MonteCarlo::simulate(book, model, seed, 0, N, into.data(), pool); });
+        bool same = std::memcmp(first.data(), into.data(), N * sizeof(PathValue)) == 0;
+        double perSecond = sim_us > 0 ? N / (sim_us / 1e6) : 0.0;
+        std::cout << N << "," << 2 * records << "," << threads << "," << book_us / 1000.0 << ","
+                  << sim_us / 1000.0 << "," << perSecond << "," << perSecond / threads << ","
+                  << maxRelErr << "," << (same ? "yes" : "no") << "\n";
+    }
+}
+
 int main(int argc, char **argv)
 {
     if (argc < 3)
     {
-        std::cerr << "usage: bench <deposits|loans|credits> N1 N2 ...\n";
+        std::cerr << "usage: bench <deposits|loans|credits|lookup|multimap|deletes|views|rebuild|psort|radix|shapes|columns|colfile|loader|pload|journal|kernels|schedule|scenarios|montecarlo|range|names|query|aggregate|display> N1 N2 ...\n";
         return 1;
     }
 
@@ -361,6 +1868,50 @@ int main(int argc, char **argv)
             benchLoans(N);
         else if (which == "credits")
             benchCredits(N);
+        else if (which == "lookup")
+            benchLookup(N);
+        else if (which == "multimap")
+            benchMultiMap(N);
+        else if (which == "deletes")
+            benchDeletes(N);
+        else if (which == "views")
+            benchViews(N);
+        else if (which == "rebuild")
+            benchRebuild(N);
+        else if (which == "psort")
+            benchParallelSort(N);
+        else if (which == "radix")
+            benchRadix(N);
+        else if (which == "shapes")
+            benchSortShapes(N);
+        else if (which == "columns")
+            benchColumns(N);
+        else if (which == "colfile")
+            benchColumnFile(N);
+        else if (which == "loader")
+            benchLoader(N);
+        else if (which == "pload")
+            benchParallelLoader(N);
+        else if (which == "journal")
+            benchJournal(N);
+        else if (which == "kernels")
+            benchKernels(N);
+        else if (which == "schedule")
+            benchSchedule(N);
+        else if (which == "scenarios")
+            benchScenarios(N);
+        else if (which == "montecarlo")
+            benchMonteCarlo(N);
+        else if (which == "range")
+            benchRange(N);
+        else if (which == "names")
+            benchNames(N);
+        else if (which == "query")
+            benchQuery(N);
+        else if (which == "aggregate")
+            benchAggregate(N);
+        else if (which == "display")
+            benchDisplay(N);
         else
         {
             std::cerr << "unknown bench: " << which << "\n";
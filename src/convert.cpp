@@ -0,0 +1,69 @@
+// src/convert.cpp
+// Converts a book between the text format in data/ and the binary
+// columnar .col format:
+//   convert <deposits|loans|credits> <in> <out.col>          (to binary)
+//   convert --text <deposits|loans|credits> <in> <out.txt>   (to text)
+// <in> may be either format; Storage::load* detects which.
+#include <iostream>
+#include <string>
+
+#include "storage.hpp"
+
+template <typename Table, typename Load, typename SaveBinary, typename SaveText>
+static int convertBook(const std::string &in, const std::string &out, bool toText,
+                       Load load, SaveBinary saveBinary, SaveText saveText)
+{
+    Table table;
+    if (!load(table, in))
+    {
+        std::cerr << "cannot read " << in << "\n";
+        return 1;
+    }
+    bool ok = toText ? saveText(table.records(), out) : saveBinary(table, out);
+    if (!ok)
+    {
+        std::cerr << "cannot write " << out << "\n";
+        return 1;
+    }
+    std::cout << table.size() << " rows -> " << out << "\n";
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int arg = 1;
+    bool toText = argc > 1 && std::string(argv[1]) == "--text";
+    if (toText)
+        ++arg;
+    if (argc - arg != 3)
+    {
+        std::cerr << "usage: convert [--text] <deposits|loans|credits> <in> <out>\n";
+        return 1;
+    }
+
+    std::string which = argv[arg];
+    std::string in = argv[arg + 1];
+    std::string out = argv[arg + 2];
+
+    if (which == "deposits")
+        return convertBook<DepositTable>(
+            in, out, toText,
+            [](DepositTable &t, const std::string &p)
+            { return Storage::loadDeposits(t, p); },
+            Storage::saveDepositsBinary, Storage::saveDeposits);
+    if (which == "loans")
+        return convertBook<LoanTable>(
+            in, out, toText,
+            [](LoanTable &t, const std::string &p)
+            { return Storage::loadLoans(t, p); },
+            Storage::saveLoansBinary, Storage::saveLoans);
+    if (which == "credits")
+        return convertBook<CreditTable>(
+            in, out, toText,
+            [](CreditTable &t, const std::string &p)
+            { return Storage::loadCredits(t, p); },
+            Storage::saveCreditsBinary, Storage::saveCredits);
+
+    std::cerr << "unknown book: " << which << "\n";
+    return 1;
+}
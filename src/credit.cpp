@@ -2,36 +2,221 @@
 #include "utilities.hpp"
 #include "storage.hpp"
 #include "ds_hash.hpp"
+#include "ds_range.hpp"
+#include "ds_trie.hpp"
+#include "query.hpp"
+#include "aggregate.hpp"
 #include "ds_linked_list.hpp"
 
 #include <iostream>
-#include <iomanip>
 #include <vector>
 #include <string>
 
 namespace Credits
 {
-    // display using view order
+    // ----- calc helpers -----
+    double calcTotal(const CreditRecord &c)
+    {
+        return c.amount + (c.amount * c.interest * c.months / 100.0);
+    }
+
+    double calcMonthly(const CreditRecord &c)
+    {
+        double total = calcTotal(c);
+        return (c.months > 0) ? total / c.months : total;
+    }
+
+    // same formulas over the columns; the name column is never read
+    void calcTotal(const CreditTable &t, std::vector<double> &out)
+    {
+        out.resize(t.size());
+        for (std::size_t i = 0; i < t.size(); ++i)
+            out[i] = t.amount[i] + (t.amount[i] * t.interest[i] * t.months[i] / 100.0);
+    }
+
+    void calcMonthly(const CreditTable &t, std::vector<double> &out)
+    {
+        calcTotal(t, out);
+        for (std::size_t i = 0; i < t.size(); ++i)
+            if (t.months[i] > 0)
+                out[i] /= t.months[i];
+    }
+
+    // display rows [offset, offset + limit) of a view, formatted into
+    // one reusable buffer and written a page at a time
     void displayAll(const std::vector<CreditRecord> &list,
-                    const std::vector<std::size_t> &order)
+                    const std::vector<std::size_t> &order,
+                    std::string &buffer,
+                    std::size_t offset = 0,
+                    std::size_t limit = SIZE_MAX)
     {
-        std::cout << "\n--- Credit / Debt Records ---\n";
-        for (std::size_t idx : order)
+        auto [first, last] = Utilities::pageOf(order.size(), offset, limit);
+        buffer.clear();
+        buffer += "\n--- Credit / Debt Records ---\n";
+        for (std::size_t i = first; i < last; ++i)
         {
-            const auto &c = list[idx];
-            double total = c.amount + (c.amount * c.interest * c.months / 100.0);
-            double monthly = (c.months > 0) ? total / c.months : total;
-
-            std::cout << std::fixed << std::setprecision(2);
-            std::cout << c.name
-                      << " | Amt=" << c.amount
-                      << " | Interest=" << c.interest << "%"
-                      << " | Months=" << c.months
-                      << " | Monthly=" << monthly
-                      << "\n";
+            const auto &c = list[order[i]];
+            buffer += c.name;
+            buffer += " | Amt=";
+            Utilities::appendFixed(buffer, c.amount, 2);
+            buffer += " | Interest=";
+            Utilities::appendFixed(buffer, c.interest, 2);
+            buffer += "% | Months=";
+            Utilities::appendNumber(buffer, c.months);
+            buffer += " | Monthly=";
+            Utilities::appendFixed(buffer, calcMonthly(c), 2);
+            buffer += '\n';
+            if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                Utilities::writeOut(buffer);
         }
+        Utilities::writeOut(buffer);
     }
 
+    // ----- search results: a "Found:" line per row, buffered like displayAll -----
+    // false (and nothing printed) when there are no rows
+    bool displayFound(const std::vector<CreditRecord> &credits, const IndexSpan *spans, std::size_t count, std::string &buffer)
+    {
+        std::size_t shown = 0;
+        buffer.clear();
+        for (std::size_t s = 0; s < count; ++s)
+            for (std::size_t idx : spans[s])
+            {
+                const auto &c = credits[idx];
+                buffer += "Found: ";
+                buffer += c.name;
+                buffer += " | Amount=";
+                Utilities::appendNumber(buffer, c.amount);
+                buffer += " | Interest=";
+                Utilities::appendNumber(buffer, c.interest);
+                buffer += " | Months=";
+                Utilities::appendNumber(buffer, c.months);
+                buffer += '\n';
+                ++shown;
+                if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                    Utilities::writeOut(buffer);
+            }
+        Utilities::writeOut(buffer);
+        return shown > 0;
+    }
+
+    bool displayFound(const std::vector<CreditRecord> &credits, IndexSpan rows, std::string &buffer)
+    {
+        return displayFound(credits, &rows, 1, buffer);
+    }
+
+    // a RangeIndex result
+    bool displayFound(const std::vector<CreditRecord> &credits, const std::vector<IndexSpan> &spans, std::string &buffer)
+    {
+        return displayFound(credits, spans.data(), spans.size(), buffer);
+    }
+
+    bool displayFound(const std::vector<CreditRecord> &credits, const std::vector<std::size_t> &rows, std::string &buffer)
+    {
+        return displayFound(credits, IndexSpan{rows.data(), rows.size()}, buffer);
+    }
+
+    // ----- summary: overall and per group -----
+    // grouped by months it reads the running totals, O(groups); by interest
+    // it is one Aggregate::groupBy pass over two columns
+    void displaySummary(const std::vector<CreditRecord> &credits,
+                        const RunningTotals<int> &amountByMonths,
+                        const RunningTotals<int> &interestByMonths,
+                        const RangeIndex<double> &amountRange,
+                        bool byInterest)
+    {
+        std::cout << "\n--- Credit / Debt summary ---\n"
+                  << "Records=" << amountByMonths.count()
+                  << " | Total amount=" << amountByMonths.sum()
+                  << " | Avg amount=" << amountByMonths.mean();
+        if (amountRange.size() > 0)
+            std::cout << " | Min amount=" << amountRange.minKey()
+                      << " | Max amount=" << amountRange.maxKey();
+        std::cout << " | Avg interest=" << interestByMonths.mean() << "\n";
+
+        if (byInterest)
+        {
+            std::vector<double> interest(credits.size()), amount(credits.size());
+            for (std::size_t i = 0; i < credits.size(); ++i)
+            {
+                interest[i] = credits[i].interest;
+                amount[i] = credits[i].amount;
+            }
+            std::vector<Aggregate::Group<double>> groups;
+            Aggregate::groupBy(interest, amount, groups);
+            for (const auto &g : groups)
+                std::cout << "Interest=" << g.key
+                          << " | Count=" << g.summary.count
+                          << " | Amount=" << g.summary.sum
+                          << " | Avg amount=" << g.summary.mean()
+                          << " | Min amount=" << g.summary.min
+                          << " | Max amount=" << g.summary.max << "\n";
+            return;
+        }
+        for (std::size_t g = 0; g < amountByMonths.groups(); ++g)
+        {
+            int months = amountByMonths.key(g);
+            std::cout << "Months=" << months
+                      << " | Count=" << amountByMonths.count(g)
+                      << " | Amount=" << amountByMonths.sum(g)
+                      << " | Avg amount=" << amountByMonths.mean(g)
+                      << " | Avg interest=" << interestByMonths.mean(interestByMonths.find(months)) << "\n";
+        }
+    }
+
+    // every index of the book, in one place
+    // rebuildAll builds them, add / removeAt / reindexAt keep them current
+    struct CreditIndexes
+    {
+        StringIntMap nameIndex{211};
+        RadixTree nameTree;     // "starts with" searches
+        TrigramIndex nameGrams; // "contains" searches
+        HashMultiMap<double> amountIndex{211};
+        HashMultiMap<double> interestIndex{211};
+        HashMultiMap<int> monthsIndex{211};
+        RangeIndex<double> amountRange;
+        RangeIndex<double> interestRange;
+        RangeIndex<int> monthsRange;
+        BitmapIndex<double> interestBits; // filter queries
+        BitmapIndex<int> monthsBits;
+        RunningTotals<int> amountByMonths; // the summary
+        RunningTotals<int> interestByMonths;
+
+        // a record appended at idx
+        void add(const CreditRecord &c, std::size_t idx)
+        {
+            nameIndex.put(c.name, idx);
+            nameTree.put(c.name, idx);
+            nameGrams.put(c.name, idx);
+            amountIndex.put(c.amount, idx);
+            interestIndex.put(c.interest, idx);
+            monthsIndex.put(c.months, idx);
+            amountRange.put(c.amount, idx);
+            interestRange.put(c.interest, idx);
+            monthsRange.put(c.months, idx);
+            interestBits.put(c.interest, idx);
+            monthsBits.put(c.months, idx);
+            amountByMonths.add(c.months, c.amount);
+            interestByMonths.add(c.months, c.interest);
+        }
+
+        void clear()
+        {
+            nameIndex = StringIntMap(211);
+            nameTree.clear();
+            nameGrams.clear();
+            amountIndex.clear();
+            interestIndex.clear();
+            monthsIndex.clear();
+            amountRange.clear();
+            interestRange.clear();
+            monthsRange.clear();
+            interestBits.clear();
+            monthsBits.clear();
+            amountByMonths.clear();
+            interestByMonths.clear();
+        }
+    };
+
     // rebuild non-unique indexes
     void rebuildValueIndexes(
         const std::vector<CreditRecord> &credits,
@@ -39,57 +224,233 @@ namespace Credits
         HashMultiMap<double> &interestIndex,
         HashMultiMap<int> &monthsIndex)
     {
-        amountIndex.clear();
-        interestIndex.clear();
-        monthsIndex.clear();
-        for (std::size_t i = 0; i < credits.size(); ++i)
-        {
-            amountIndex.put(credits[i].amount, i);
-            interestIndex.put(credits[i].interest, i);
-            monthsIndex.put(credits[i].months, i);
-        }
+        amountIndex.build(credits.begin(), credits.end(),
+                          [](const CreditRecord &c)
+                          { return c.amount; });
+        interestIndex.build(credits.begin(), credits.end(),
+                            [](const CreditRecord &c)
+                            { return c.interest; });
+        monthsIndex.build(credits.begin(), credits.end(),
+                          [](const CreditRecord &c)
+                          { return c.months; });
     }
 
-    void rebuildAll(std::vector<CreditRecord> &credits,
-                    std::vector<std::size_t> &viewOrder,
-                    StringIntMap &nameIndex,
-                    HashMultiMap<double> &amountIndex,
-                    HashMultiMap<double> &interestIndex,
-                    HashMultiMap<int> &monthsIndex)
+    // rebuild ordered indexes (the "between" searches)
+    void rebuildRangeIndexes(
+        const std::vector<CreditRecord> &credits,
+        RangeIndex<double> &amountRange,
+        RangeIndex<double> &interestRange,
+        RangeIndex<int> &monthsRange)
+    {
+        amountRange.build(credits,
+                          [](const CreditRecord &c)
+                          { return c.amount; });
+        interestRange.build(credits,
+                            [](const CreditRecord &c)
+                            { return c.interest; });
+        monthsRange.build(credits,
+                          [](const CreditRecord &c)
+                          { return c.months; });
+    }
+
+    // rebuild bitmap indexes (the filter queries)
+    void rebuildBitmapIndexes(
+        const std::vector<CreditRecord> &credits,
+        BitmapIndex<double> &interestBits,
+        BitmapIndex<int> &monthsBits)
     {
-        Utilities::quickSort(credits, CreditSort::byName);
+        interestBits.build(credits,
+                           [](const CreditRecord &c)
+                           { return c.interest; });
+        monthsBits.build(credits,
+                         [](const CreditRecord &c)
+                         { return c.months; });
+    }
 
+    // rebuild running totals (the summary)
+    void rebuildTotals(
+        const std::vector<CreditRecord> &credits,
+        RunningTotals<int> &amountByMonths,
+        RunningTotals<int> &interestByMonths)
+    {
+        amountByMonths.build(credits,
+                             [](const CreditRecord &c)
+                             { return c.months; },
+                             [](const CreditRecord &c)
+                             { return c.amount; });
+        interestByMonths.build(credits,
+                               [](const CreditRecord &c)
+                               { return c.months; },
+                               [](const CreditRecord &c)
+                               { return c.interest; });
+    }
+
+    void rebuildAll(const std::vector<CreditRecord> &credits,
+                    std::vector<std::size_t> &viewOrder,
+                    CreditIndexes &indexes,
+                    const Storage::LoadInfo *loaded = nullptr)
+    {
         viewOrder.clear();
         viewOrder.reserve(credits.size());
         for (std::size_t i = 0; i < credits.size(); ++i)
             viewOrder.push_back(i);
-        Utilities::quickSortIndices(viewOrder, credits, CreditSort::byName);
+        Utilities::sortView(viewOrder, credits, CreditSort::byName, ThreadPool::shared());
 
-        nameIndex = StringIntMap(211);
-        for (std::size_t i = 0; i < credits.size(); ++i)
-            nameIndex.put(credits[i].name, i);
+        indexes.nameIndex.build(credits.begin(), credits.end(),
+                                [](const CreditRecord &c) -> const std::string &
+                                { return c.name; },
+                                loaded ? loaded->nameHashes(credits.size()) : nullptr, loaded ? loaded->nameBytes : 0);
+        indexes.nameTree.build(credits, viewOrder,
+                               [](const CreditRecord &c) -> const std::string &
+                               { return c.name; });
+        indexes.nameGrams.build(credits,
+                                [](const CreditRecord &c) -> const std::string &
+                                { return c.name; });
+
+        rebuildValueIndexes(credits, indexes.amountIndex, indexes.interestIndex, indexes.monthsIndex);
+        rebuildRangeIndexes(credits, indexes.amountRange, indexes.interestRange, indexes.monthsRange);
+        rebuildBitmapIndexes(credits, indexes.interestBits, indexes.monthsBits);
+        rebuildTotals(credits, indexes.amountByMonths, indexes.interestByMonths);
+    }
+
+    // ----- delete: swap-and-pop, patch only the touched index entries -----
+    // the last record moves into idx, so its postings are renamed
+    // last -> idx; nothing is re-sorted or rebuilt
+    void removeAt(std::vector<CreditRecord> &credits,
+                  std::vector<std::size_t> &viewOrder,
+                  bool (*viewBy)(const CreditRecord &, const CreditRecord &),
+                  bool viewSorted,
+                  CreditIndexes &indexes,
+                  std::size_t idx)
+    {
+        std::size_t last = credits.size() - 1;
+        const CreditRecord &gone = credits[idx];
+        indexes.nameTree.erase(gone.name, idx);
+        std::size_t named;
+        if (indexes.nameIndex.get(gone.name, named) && named == idx)
+        {
+            // names may repeat: hand the name to another record that has it
+            IndexSpan same = indexes.nameTree.rowsOf(gone.name);
+            if (same.empty())
+                indexes.nameIndex.erase(gone.name);
+            else
+                indexes.nameIndex.put(gone.name, same[0]);
+        }
+        indexes.nameGrams.erase(gone.name, idx);
+        indexes.amountIndex.erase(gone.amount, idx);
+        indexes.interestIndex.erase(gone.interest, idx);
+        indexes.monthsIndex.erase(gone.months, idx);
+        indexes.amountRange.erase(gone.amount, idx);
+        indexes.interestRange.erase(gone.interest, idx);
+        indexes.monthsRange.erase(gone.months, idx);
+        indexes.interestBits.erase(gone.interest, idx);
+        indexes.monthsBits.erase(gone.months, idx);
+        indexes.amountByMonths.remove(gone.months, gone.amount);
+        indexes.interestByMonths.remove(gone.months, gone.interest);
+
+        if (idx != last)
+        {
+            const CreditRecord &moved = credits[last];
+            if (indexes.nameIndex.get(moved.name, named) && named == last)
+                indexes.nameIndex.put(moved.name, idx);
+            indexes.nameTree.replace(moved.name, last, idx);
+            indexes.nameGrams.replace(moved.name, last, idx);
+            indexes.amountIndex.replace(moved.amount, last, idx);
+            indexes.interestIndex.replace(moved.interest, last, idx);
+            indexes.monthsIndex.replace(moved.months, last, idx);
+            indexes.amountRange.replace(moved.amount, last, idx);
+            indexes.interestRange.replace(moved.interest, last, idx);
+            indexes.monthsRange.replace(moved.months, last, idx);
+            indexes.interestBits.replace(moved.interest, last, idx);
+            indexes.monthsBits.replace(moved.months, last, idx);
+            credits[idx] = std::move(credits[last]);
+        }
+        credits.pop_back();
+        if (viewSorted)
+            Utilities::dropFromView(viewOrder, credits, idx, last, viewBy);
+        else
+            Utilities::dropFromView(viewOrder, idx, last);
+    }
+
+    // ----- update: re-post only the fields that changed -----
+    // no re-sort; a sorted view just moves the one entry
+    void reindexAt(const std::vector<CreditRecord> &credits,
+                   std::vector<std::size_t> &viewOrder,
+                   bool (*viewBy)(const CreditRecord &, const CreditRecord &),
+                   bool viewSorted,
+                   CreditIndexes &indexes,
+                   std::size_t idx,
+                   const CreditRecord &before)
+    {
+        const CreditRecord &now = credits[idx];
+        if (now.amount != before.amount)
+        {
+            indexes.amountIndex.erase(before.amount, idx);
+            indexes.amountIndex.put(now.amount, idx);
+            indexes.amountRange.erase(before.amount, idx);
+            indexes.amountRange.put(now.amount, idx);
+        }
+        if (now.interest != before.interest)
+        {
+            indexes.interestIndex.erase(before.interest, idx);
+            indexes.interestIndex.put(now.interest, idx);
+            indexes.interestRange.erase(before.interest, idx);
+            indexes.interestRange.put(now.interest, idx);
+            indexes.interestBits.erase(before.interest, idx);
+            indexes.interestBits.put(now.interest, idx);
+        }
+        if (now.months != before.months)
+        {
+            indexes.monthsIndex.erase(before.months, idx);
+            indexes.monthsIndex.put(now.months, idx);
+            indexes.monthsRange.erase(before.months, idx);
+            indexes.monthsRange.put(now.months, idx);
+            indexes.monthsBits.erase(before.months, idx);
+            indexes.monthsBits.put(now.months, idx);
+        }
+
+        if (now.amount != before.amount || now.months != before.months)
+        {
+            indexes.amountByMonths.remove(before.months, before.amount);
+            indexes.amountByMonths.add(now.months, now.amount);
+        }
+        if (now.interest != before.interest || now.months != before.months)
+        {
+            indexes.interestByMonths.remove(before.months, before.interest);
+            indexes.interestByMonths.add(now.months, now.interest);
+        }
 
-        rebuildValueIndexes(credits, amountIndex, interestIndex, monthsIndex);
+        if (viewSorted)
+            Utilities::repositionInView(viewOrder, credits, idx, before, viewBy);
     }
 
     void showMenu()
     {
         // load
         std::vector<CreditRecord> credits;
-        Storage::loadCredits(credits, "data/credits.txt");
+        Storage::Journal<CreditRecord> journal("data/credits.txt");
+        Storage::LoadInfo loaded;
+        journal.load(credits, &loaded);
 
         // build
         std::vector<std::size_t> viewOrder;
-        StringIntMap nameIndex(211);
-        HashMultiMap<double> amountIndex(211);
-        HashMultiMap<double> interestIndex(211);
-        HashMultiMap<int> monthsIndex(211);
-        rebuildAll(credits, viewOrder, nameIndex, amountIndex, interestIndex, monthsIndex);
+        CreditIndexes indexes;
+        std::vector<IndexSpan> spans; // reused by the "between" searches
+        std::vector<std::size_t> hits; // and the partial-name, filter and top-K ones
+        std::string display; // every view is formatted here, then written at once
+        rebuildAll(credits, viewOrder, indexes, &loaded);
+        loaded = Storage::LoadInfo(); // only the first build uses it
+
+        // what viewOrder is sorted by; adds append, so it's unsorted until the next sort
+        bool (*viewBy)(const CreditRecord &, const CreditRecord &) = CreditSort::byName;
+        bool viewSorted = true;
 
         DSLinkedList<std::string> recent;
 
         while (true)
         {
+            journal.maybeCompact(credits);
+
             std::cout << "\n[Credits / Debts]\n"
                       << "1) Add record\n"
                       << "2) View all records\n"
@@ -99,7 +460,9 @@ namespace Credits
                       << "6) Delete record\n"
                       << "7) Reset data\n"
                       << "8) Load sample data\n"
-                      << "9) Back\n"
+                      << "9) Summary\n"
+                      << "10) Page / top K\n"
+                      << "11) Back\n"
                       << "Choice: ";
 
             int ch;
@@ -123,22 +486,21 @@ namespace Credits
                 std::cin >> c.months;
 
                 credits.push_back(c);
+                journal.add(c);
                 std::size_t idx = credits.size() - 1;
 
                 // incremental index updates
-                nameIndex.put(c.name, idx);
-                amountIndex.put(c.amount, idx);
-                interestIndex.put(c.interest, idx);
-                monthsIndex.put(c.months, idx);
+                indexes.add(c, idx);
 
                 viewOrder.push_back(idx);
+                viewSorted = false;
 
                 recent.pushFront("Added credit: " + c.name);
                 std::cout << "Record added.\n";
             }
             else if (ch == 2)
             {
-                displayAll(credits, viewOrder);
+                displayAll(credits, viewOrder, display);
             }
             else if (ch == 3) // sort view
             {
@@ -153,19 +515,30 @@ namespace Credits
                 switch (s)
                 {
                 case 1:
-                    Utilities::quickSortIndices(viewOrder, credits, CreditSort::byName);
+                    viewBy = CreditSort::byName;
+                    viewSorted = true;
+                    Utilities::sortView(viewOrder, credits, viewBy, ThreadPool::shared());
                     std::cout << "Sorted by name.\n";
                     break;
                 case 2:
-                    Utilities::quickSortIndices(viewOrder, credits, CreditSort::byAmount);
+                    viewBy = CreditSort::byAmount;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, credits, [](const CreditRecord &c)
+                                             { return c.amount; });
                     std::cout << "Sorted by amount.\n";
                     break;
                 case 3:
-                    Utilities::quickSortIndices(viewOrder, credits, CreditSort::byInterest);
+                    viewBy = CreditSort::byInterest;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, credits, [](const CreditRecord &c)
+                                             { return c.interest; });
                     std::cout << "Sorted by interest.\n";
                     break;
                 case 4:
-                    Utilities::quickSortIndices(viewOrder, credits, CreditSort::byMonths);
+                    viewBy = CreditSort::byMonths;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, credits, [](const CreditRecord &c)
+                                             { return c.months; });
                     std::cout << "Sorted by months.\n";
                     break;
                 default:
@@ -187,6 +560,12 @@ namespace Credits
                           << "2) Amount\n"
                           << "3) Interest\n"
                           << "4) Months\n"
+                          << "5) Amount between\n"
+                          << "6) Interest between\n"
+                          << "7) Months between\n"
+                          << "8) Name starts with\n"
+                          << "9) Name contains\n"
+                          << "10) Filter (e.g. months <= 12 AND interest >= 7.5 AND amount > 10000)\n"
                           << "Choice: ";
                 int s;
                 std::cin >> s;
@@ -198,14 +577,8 @@ namespace Credits
                     std::getline(std::cin >> std::ws, key); // ⭐ full name with spaces
 
                     std::size_t idx;
-                    if (nameIndex.get(key, idx))
-                    {
-                        const auto &c = credits[idx];
-                        std::cout << "Found: " << c.name
-                                  << " | Amount=" << c.amount
-                                  << " | Interest=" << c.interest
-                                  << " | Months=" << c.months << "\n";
-                    }
+                    if (indexes.nameIndex.get(key, idx))
+                        displayFound(credits, IndexSpan{&idx, 1}, display);
                     else
                         std::cout << "Record not found.\n";
                 }
@@ -214,19 +587,7 @@ namespace Credits
                     std::cout << "Enter amount: ";
                     double amt;
                     std::cin >> amt;
-                    std::vector<std::size_t> matches;
-                    if (amountIndex.get(amt, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &c = credits[idx];
-                            std::cout << "Found: " << c.name
-                                      << " | Amount=" << c.amount
-                                      << " | Interest=" << c.interest
-                                      << " | Months=" << c.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(credits, indexes.amountIndex.get(amt), display))
                         std::cout << "No records with that amount.\n";
                 }
                 else if (s == 3)
@@ -234,19 +595,7 @@ namespace Credits
                     std::cout << "Enter interest (%): ";
                     double r;
                     std::cin >> r;
-                    std::vector<std::size_t> matches;
-                    if (interestIndex.get(r, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &c = credits[idx];
-                            std::cout << "Found: " << c.name
-                                      << " | Amount=" << c.amount
-                                      << " | Interest=" << c.interest
-                                      << " | Months=" << c.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(credits, indexes.interestIndex.get(r), display))
                         std::cout << "No records with that interest.\n";
                 }
                 else if (s == 4)
@@ -254,38 +603,101 @@ namespace Credits
                     std::cout << "Enter months: ";
                     int m;
                     std::cin >> m;
-                    std::vector<std::size_t> matches;
-                    if (monthsIndex.get(m, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &c = credits[idx];
-                            std::cout << "Found: " << c.name
-                                      << " | Amount=" << c.amount
-                                      << " | Interest=" << c.interest
-                                      << " | Months=" << c.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(credits, indexes.monthsIndex.get(m), display))
                         std::cout << "No records with that tenure.\n";
                 }
+                else if (s == 5)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest amount: ";
+                    std::cin >> lo;
+                    std::cout << "Highest amount: ";
+                    std::cin >> hi;
+                    indexes.amountRange.range(lo, hi, spans);
+                    if (!displayFound(credits, spans, display))
+                        std::cout << "No records with amount in that range.\n";
+                }
+                else if (s == 6)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest interest: ";
+                    std::cin >> lo;
+                    std::cout << "Highest interest: ";
+                    std::cin >> hi;
+                    indexes.interestRange.range(lo, hi, spans);
+                    if (!displayFound(credits, spans, display))
+                        std::cout << "No records with interest in that range.\n";
+                }
+                else if (s == 7)
+                {
+                    int lo, hi;
+                    std::cout << "Lowest months: ";
+                    std::cin >> lo;
+                    std::cout << "Highest months: ";
+                    std::cin >> hi;
+                    indexes.monthsRange.range(lo, hi, spans);
+                    if (!displayFound(credits, spans, display))
+                        std::cout << "No records with months in that range.\n";
+                }
+                else if (s == 8)
+                {
+                    std::cout << "Name starts with: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameTree.withPrefix(part, hits); // already in name order
+                            if (!displayFound(credits, hits, display))
+                                std::cout << "No records with a name that starts with that.\n";
+                }
+                else if (s == 9)
+                {
+                    std::cout << "Name contains: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameGrams.withSubstring(part, credits, [](const CreditRecord &c) -> const std::string &
+                                                    { return c.name; },
+                                                    hits);
+                    Utilities::quickSortIndices(hits, credits, CreditSort::byName, ThreadPool::shared());
+                    if (!displayFound(credits, hits, display))
+                        std::cout << "No records with a name that contains that.\n";
+                }
+                else if (s == 10)
+                {
+                    std::cout << "Filter: ";
+                    std::string text, error;
+                    std::getline(std::cin >> std::ws, text);
+                    std::vector<Query::Condition> conditions;
+                    std::vector<Query::Field> fields(3);
+                    fields[0].name = "amount";
+                    fields[0].doubleRange = &indexes.amountRange;
+                    fields[0].valueOf = [&](std::size_t idx)
+                    { return credits[idx].amount; };
+                    fields[1].name = "interest";
+                    fields[1].doubleBits = &indexes.interestBits;
+                    fields[2].name = "months";
+                    fields[2].intBits = &indexes.monthsBits;
+                    if (!Query::parse(text, conditions, error) || !Query::run(fields, conditions, hits, error))
+                        std::cout << error << "\n";
+                    else if (!displayFound(credits, hits, display))
+                        std::cout << "No records match that filter.\n";
+                }
                 else
                     std::cout << "Invalid search option.\n";
             }
-            else if (ch == 5) // update → rebuild
+            else if (ch == 5) // update (incremental)
             {
                 std::cout << "Enter name to update: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ full name with spaces
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
                     auto &c = credits[idx];
+                    CreditRecord before = c;
                     std::cout << "New amount (" << c.amount << "): ";
                     std::cin >> c.amount;
                     std::cout << "New interest (" << c.interest << "): ";
@@ -293,26 +705,27 @@ namespace Credits
                     std::cout << "New months (" << c.months << "): ";
                     std::cin >> c.months;
 
-                    rebuildAll(credits, viewOrder, nameIndex, amountIndex, interestIndex, monthsIndex);
+                    reindexAt(credits, viewOrder, viewBy, viewSorted, indexes, idx, before);
+                    journal.update(idx, credits[idx]);
                     recent.pushFront("Updated credit: " + key);
                     std::cout << "Updated.\n";
                 }
             }
-            else if (ch == 6) // delete → rebuild
+            else if (ch == 6) // delete (swap-and-pop)
             {
                 std::cout << "Enter name to delete: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ full name with spaces
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
-                    credits.erase(credits.begin() + idx);
-                    rebuildAll(credits, viewOrder, nameIndex, amountIndex, interestIndex, monthsIndex);
+                    journal.remove(idx);
+                    removeAt(credits, viewOrder, viewBy, viewSorted, indexes, idx);
                     recent.pushFront("Deleted credit: " + key);
                     std::cout << "Deleted.\n";
                 }
@@ -321,13 +734,10 @@ namespace Credits
             {
                 credits.clear();
                 viewOrder.clear();
-                nameIndex = StringIntMap(211);
-                amountIndex.clear();
-                interestIndex.clear();
-                monthsIndex.clear();
+                viewSorted = true;
+                indexes.clear();
 
-                std::vector<CreditRecord> empty;
-                Storage::saveCredits(empty, "data/credits.txt");
+                journal.replaceAll(credits);
 
                 recent.pushFront("Reset credit data");
                 std::cout << "All credit/debt data reset.\n";
@@ -337,17 +747,69 @@ namespace Credits
                 std::vector<CreditRecord> sample;
                 Storage::loadCredits(sample, "data/credits_sample.txt");
                 credits = sample;
-                rebuildAll(credits, viewOrder, nameIndex, amountIndex, interestIndex, monthsIndex);
+                journal.replaceAll(credits);
+                rebuildAll(credits, viewOrder, indexes);
+                viewBy = CreditSort::byName;
+                viewSorted = true;
                 recent.pushFront("Loaded sample credits");
                 std::cout << "Sample credit/debt data loaded.\n";
             }
+            else if (ch == 9) // summary (running totals)
+            {
+                std::cout << "Group by:\n"
+                          << "1) Months\n"
+                          << "2) Interest\n"
+                          << "Choice: ";
+                int g;
+                std::cin >> g;
+                displaySummary(credits, indexes.amountByMonths, indexes.interestByMonths, indexes.amountRange, g == 2);
+            }
+            else if (ch == 10) // page of the view, or top K
+            {
+                std::cout << "1) Page of the current view\n"
+                          << "2) Top K by amount\n"
+                          << "3) Top K by interest\n"
+                          << "4) Top K by months\n"
+                          << "Choice: ";
+                int v;
+                std::cin >> v;
+                if (v == 1)
+                {
+                    std::size_t offset = 0, limit = 0;
+                    std::cout << "First row (from 0): ";
+                    std::cin >> offset;
+                    std::cout << "Rows: ";
+                    std::cin >> limit;
+                    displayAll(credits, viewOrder, display, offset, limit);
+                }
+                else if (v >= 2 && v <= 4)
+                {
+                    std::size_t k = 0;
+                    std::cout << "K: ";
+                    std::cin >> k;
+                    // largest first; no full sort
+                    if (v == 2)
+                        Utilities::topKIndices(hits, credits, k, [](const CreditRecord &a, const CreditRecord &b)
+                                               { return CreditSort::byAmount(b, a); });
+                    else if (v == 3)
+                        Utilities::topKIndices(hits, credits, k, [](const CreditRecord &a, const CreditRecord &b)
+                                               { return CreditSort::byInterest(b, a); });
+                    else if (v == 4)
+                        Utilities::topKIndices(hits, credits, k, [](const CreditRecord &a, const CreditRecord &b)
+                                               { return CreditSort::byMonths(b, a); });
+                    displayAll(credits, hits, display);
+                }
+                else
+                    std::cout << "Invalid view option.\n";
+            }
             else
             {
                 break;
             }
         }
 
-        Storage::saveCredits(credits, "data/credits.txt");
+        // snapshot on exit, skipped when nothing changed
+        journal.checkpoint(credits);
     }
 
 } // namespace Credits
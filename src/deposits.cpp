@@ -1,6 +1,10 @@
 #include "utilities.hpp"
 #include "ds_linked_list.hpp"
 #include "ds_hash.hpp"
+#include "ds_range.hpp"
+#include "ds_trie.hpp"
+#include "query.hpp"
+#include "aggregate.hpp"
 #include "storage.hpp"
 #include "deposits.hpp"
 #include <iostream>
@@ -21,21 +25,194 @@ namespace Deposits
         return d.amount + calcSimple(d);
     }
 
-    // ----- display using viewOrder -----
+    // same formulas over the columns; the name column is never read
+    void calcSimple(const DepositTable &t, std::vector<double> &out)
+    {
+        out.resize(t.size());
+        for (std::size_t i = 0; i < t.size(); ++i)
+            out[i] = t.amount[i] * t.rate[i] * (t.months[i] / 12.0) / 100.0;
+    }
+
+    void calcMaturity(const DepositTable &t, std::vector<double> &out)
+    {
+        calcSimple(t, out);
+        for (std::size_t i = 0; i < t.size(); ++i)
+            out[i] += t.amount[i];
+    }
+
+    // ----- display rows [offset, offset + limit) of a view -----
+    // formatted into one reusable buffer, written a page at a time
     void displayAll(const std::vector<Deposit> &list,
-                    const std::vector<std::size_t> &order)
+                    const std::vector<std::size_t> &order,
+                    std::string &buffer,
+                    std::size_t offset = 0,
+                    std::size_t limit = SIZE_MAX)
+    {
+        auto [first, last] = Utilities::pageOf(order.size(), offset, limit);
+        buffer.clear();
+        buffer += "\n--- Deposits ---\n";
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const auto &d = list[order[i]];
+            buffer += d.name;
+            buffer += " | Amt=";
+            Utilities::appendNumber(buffer, d.amount);
+            buffer += " | Rate=";
+            Utilities::appendNumber(buffer, d.rate);
+            buffer += " | Tenure=";
+            Utilities::appendNumber(buffer, d.months);
+            buffer += " months\n";
+            if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                Utilities::writeOut(buffer);
+        }
+        Utilities::writeOut(buffer);
+    }
+
+    // ----- search results: a "Found:" line per row, buffered like displayAll -----
+    // false (and nothing printed) when there are no rows
+    bool displayFound(const std::vector<Deposit> &deposits, const IndexSpan *spans, std::size_t count, std::string &buffer)
+    {
+        std::size_t shown = 0;
+        buffer.clear();
+        for (std::size_t s = 0; s < count; ++s)
+            for (std::size_t idx : spans[s])
+            {
+                const auto &d = deposits[idx];
+                buffer += "Found: ";
+                buffer += d.name;
+                buffer += " | Amt=";
+                Utilities::appendNumber(buffer, d.amount);
+                buffer += " | Rate=";
+                Utilities::appendNumber(buffer, d.rate);
+                buffer += " | Months=";
+                Utilities::appendNumber(buffer, d.months);
+                buffer += '\n';
+                ++shown;
+                if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                    Utilities::writeOut(buffer);
+            }
+        Utilities::writeOut(buffer);
+        return shown > 0;
+    }
+
+    bool displayFound(const std::vector<Deposit> &deposits, IndexSpan rows, std::string &buffer)
     {
-        std::cout << "\n--- Deposits ---\n";
-        for (std::size_t idx : order)
+        return displayFound(deposits, &rows, 1, buffer);
+    }
+
+    // a RangeIndex result
+    bool displayFound(const std::vector<Deposit> &deposits, const std::vector<IndexSpan> &spans, std::string &buffer)
+    {
+        return displayFound(deposits, spans.data(), spans.size(), buffer);
+    }
+
+    bool displayFound(const std::vector<Deposit> &deposits, const std::vector<std::size_t> &rows, std::string &buffer)
+    {
+        return displayFound(deposits, IndexSpan{rows.data(), rows.size()}, buffer);
+    }
+
+    // ----- summary: overall and per group -----
+    // grouped by months it reads the running totals, O(groups); by rate
+    // it is one Aggregate::groupBy pass over two columns
+    void displaySummary(const std::vector<Deposit> &deposits,
+                        const RunningTotals<int> &amountByMonths,
+                        const RunningTotals<int> &rateByMonths,
+                        const RangeIndex<double> &amountRange,
+                        bool byRate)
+    {
+        std::cout << "\n--- Deposit summary ---\n"
+                  << "Deposits=" << amountByMonths.count()
+                  << " | Total amount=" << amountByMonths.sum()
+                  << " | Avg amount=" << amountByMonths.mean();
+        if (amountRange.size() > 0)
+            std::cout << " | Min amount=" << amountRange.minKey()
+                      << " | Max amount=" << amountRange.maxKey();
+        std::cout << " | Avg rate=" << rateByMonths.mean() << "\n";
+
+        if (byRate)
+        {
+            std::vector<double> rate(deposits.size()), amount(deposits.size());
+            for (std::size_t i = 0; i < deposits.size(); ++i)
+            {
+                rate[i] = deposits[i].rate;
+                amount[i] = deposits[i].amount;
+            }
+            std::vector<Aggregate::Group<double>> groups;
+            Aggregate::groupBy(rate, amount, groups);
+            for (const auto &g : groups)
+                std::cout << "Rate=" << g.key
+                          << " | Count=" << g.summary.count
+                          << " | Amount=" << g.summary.sum
+                          << " | Avg amount=" << g.summary.mean()
+                          << " | Min amount=" << g.summary.min
+                          << " | Max amount=" << g.summary.max << "\n";
+            return;
+        }
+        for (std::size_t g = 0; g < amountByMonths.groups(); ++g)
         {
-            const auto &d = list[idx];
-            std::cout << d.name
-                      << " | Amt=" << d.amount
-                      << " | Rate=" << d.rate
-                      << " | Tenure=" << d.months << " months\n";
+            int months = amountByMonths.key(g);
+            std::cout << "Months=" << months
+                      << " | Count=" << amountByMonths.count(g)
+                      << " | Amount=" << amountByMonths.sum(g)
+                      << " | Avg amount=" << amountByMonths.mean(g)
+                      << " | Avg rate=" << rateByMonths.mean(rateByMonths.find(months)) << "\n";
         }
     }
 
+    // ----- every index of the book, in one place -----
+    // rebuildAll builds them, add / removeAt / reindexAt keep them current
+    struct DepositIndexes
+    {
+        StringIntMap nameIndex{211};
+        RadixTree nameTree;     // "starts with" searches
+        TrigramIndex nameGrams; // "contains" searches
+        HashMultiMap<double> amountIndex{211};
+        HashMultiMap<double> rateIndex{211};
+        HashMultiMap<int> monthsIndex{211};
+        RangeIndex<double> amountRange;
+        RangeIndex<double> rateRange;
+        RangeIndex<int> monthsRange;
+        BitmapIndex<double> rateBits; // filter queries
+        BitmapIndex<int> monthsBits;
+        RunningTotals<int> amountByMonths; // the summary
+        RunningTotals<int> rateByMonths;
+
+        // a record appended at idx
+        void add(const Deposit &d, std::size_t idx)
+        {
+            nameIndex.put(d.name, idx);
+            nameTree.put(d.name, idx);
+            nameGrams.put(d.name, idx);
+            amountIndex.put(d.amount, idx);
+            rateIndex.put(d.rate, idx);
+            monthsIndex.put(d.months, idx);
+            amountRange.put(d.amount, idx);
+            rateRange.put(d.rate, idx);
+            monthsRange.put(d.months, idx);
+            rateBits.put(d.rate, idx);
+            monthsBits.put(d.months, idx);
+            amountByMonths.add(d.months, d.amount);
+            rateByMonths.add(d.months, d.rate);
+        }
+
+        void clear()
+        {
+            nameIndex = StringIntMap(211);
+            nameTree.clear();
+            nameGrams.clear();
+            amountIndex.clear();
+            rateIndex.clear();
+            monthsIndex.clear();
+            amountRange.clear();
+            rateRange.clear();
+            monthsRange.clear();
+            rateBits.clear();
+            monthsBits.clear();
+            amountByMonths.clear();
+            rateByMonths.clear();
+        }
+    };
+
     // ----- rebuild non-unique indexes -----
     void rebuildValueIndexes(
         const std::vector<Deposit> &deposits,
@@ -43,63 +220,241 @@ namespace Deposits
         HashMultiMap<double> &rateIndex,
         HashMultiMap<int> &monthsIndex)
     {
-        amountIndex.clear();
-        rateIndex.clear();
-        monthsIndex.clear();
-        for (std::size_t i = 0; i < deposits.size(); ++i)
-        {
-            amountIndex.put(deposits[i].amount, i);
-            rateIndex.put(deposits[i].rate, i);
-            monthsIndex.put(deposits[i].months, i);
-        }
+        amountIndex.build(deposits.begin(), deposits.end(),
+                          [](const Deposit &d)
+                          { return d.amount; });
+        rateIndex.build(deposits.begin(), deposits.end(),
+                        [](const Deposit &d)
+                        { return d.rate; });
+        monthsIndex.build(deposits.begin(), deposits.end(),
+                          [](const Deposit &d)
+                          { return d.months; });
+    }
+
+    // ----- rebuild ordered indexes (the "between" searches) -----
+    void rebuildRangeIndexes(
+        const std::vector<Deposit> &deposits,
+        RangeIndex<double> &amountRange,
+        RangeIndex<double> &rateRange,
+        RangeIndex<int> &monthsRange)
+    {
+        amountRange.build(deposits,
+                          [](const Deposit &d)
+                          { return d.amount; });
+        rateRange.build(deposits,
+                        [](const Deposit &d)
+                        { return d.rate; });
+        monthsRange.build(deposits,
+                          [](const Deposit &d)
+                          { return d.months; });
+    }
+
+    // ----- rebuild bitmap indexes (the filter queries) -----
+    void rebuildBitmapIndexes(
+        const std::vector<Deposit> &deposits,
+        BitmapIndex<double> &rateBits,
+        BitmapIndex<int> &monthsBits)
+    {
+        rateBits.build(deposits,
+                       [](const Deposit &d)
+                       { return d.rate; });
+        monthsBits.build(deposits,
+                         [](const Deposit &d)
+                         { return d.months; });
+    }
+
+    // ----- rebuild running totals (the summary) -----
+    void rebuildTotals(
+        const std::vector<Deposit> &deposits,
+        RunningTotals<int> &amountByMonths,
+        RunningTotals<int> &rateByMonths)
+    {
+        amountByMonths.build(deposits,
+                             [](const Deposit &d)
+                             { return d.months; },
+                             [](const Deposit &d)
+                             { return d.amount; });
+        rateByMonths.build(deposits,
+                           [](const Deposit &d)
+                           { return d.months; },
+                           [](const Deposit &d)
+                           { return d.rate; });
     }
 
     // ----- full rebuild (expensive) -----
-    void rebuildAll(std::vector<Deposit> &deposits,
+    void rebuildAll(const std::vector<Deposit> &deposits,
                     std::vector<std::size_t> &viewOrder,
-                    StringIntMap &nameIndex,
-                    HashMultiMap<double> &amountIndex,
-                    HashMultiMap<double> &rateIndex,
-                    HashMultiMap<int> &monthsIndex)
+                    DepositIndexes &indexes,
+                    const Storage::LoadInfo *loaded = nullptr)
     {
-        // main vector sorted by name only during full rebuilds
-        Utilities::quickSort(deposits, DepositSort::byName);
+        // records stay in stored order (journal entries address them by
+        // position); only the view is sorted
 
         // rebuild view
         viewOrder.clear();
         viewOrder.reserve(deposits.size());
         for (std::size_t i = 0; i < deposits.size(); ++i)
             viewOrder.push_back(i);
-        Utilities::quickSortIndices(viewOrder, deposits, DepositSort::byName);
+        Utilities::sortView(viewOrder, deposits, DepositSort::byName, ThreadPool::shared());
 
         // rebuild name hash
-        nameIndex = StringIntMap(211);
-        for (std::size_t i = 0; i < deposits.size(); ++i)
-            nameIndex.put(deposits[i].name, i);
+        indexes.nameIndex.build(deposits.begin(), deposits.end(),
+                                [](const Deposit &d) -> const std::string &
+                                { return d.name; },
+                                loaded ? loaded->nameHashes(deposits.size()) : nullptr, loaded ? loaded->nameBytes : 0);
+        indexes.nameTree.build(deposits, viewOrder,
+                               [](const Deposit &d) -> const std::string &
+                               { return d.name; });
+        indexes.nameGrams.build(deposits,
+                                [](const Deposit &d) -> const std::string &
+                                { return d.name; });
 
         // rebuild value hashes
-        rebuildValueIndexes(deposits, amountIndex, rateIndex, monthsIndex);
+        rebuildValueIndexes(deposits, indexes.amountIndex, indexes.rateIndex, indexes.monthsIndex);
+        rebuildRangeIndexes(deposits, indexes.amountRange, indexes.rateRange, indexes.monthsRange);
+        rebuildBitmapIndexes(deposits, indexes.rateBits, indexes.monthsBits);
+        rebuildTotals(deposits, indexes.amountByMonths, indexes.rateByMonths);
+    }
+
+    // ----- delete: swap-and-pop, patch only the touched index entries -----
+    // the last record moves into idx, so its postings are renamed
+    // last -> idx; nothing is re-sorted or rebuilt
+    void removeAt(std::vector<Deposit> &deposits,
+                  std::vector<std::size_t> &viewOrder,
+                  bool (*viewBy)(const Deposit &, const Deposit &),
+                  bool viewSorted,
+                  DepositIndexes &indexes,
+                  std::size_t idx)
+    {
+        std::size_t last = deposits.size() - 1;
+        const Deposit &gone = deposits[idx];
+        indexes.nameTree.erase(gone.name, idx);
+        std::size_t named;
+        if (indexes.nameIndex.get(gone.name, named) && named == idx)
+        {
+            // names may repeat: hand the name to another record that has it
+            IndexSpan same = indexes.nameTree.rowsOf(gone.name);
+            if (same.empty())
+                indexes.nameIndex.erase(gone.name);
+            else
+                indexes.nameIndex.put(gone.name, same[0]);
+        }
+        indexes.nameGrams.erase(gone.name, idx);
+        indexes.amountIndex.erase(gone.amount, idx);
+        indexes.rateIndex.erase(gone.rate, idx);
+        indexes.monthsIndex.erase(gone.months, idx);
+        indexes.amountRange.erase(gone.amount, idx);
+        indexes.rateRange.erase(gone.rate, idx);
+        indexes.monthsRange.erase(gone.months, idx);
+        indexes.rateBits.erase(gone.rate, idx);
+        indexes.monthsBits.erase(gone.months, idx);
+        indexes.amountByMonths.remove(gone.months, gone.amount);
+        indexes.rateByMonths.remove(gone.months, gone.rate);
+
+        if (idx != last)
+        {
+            const Deposit &moved = deposits[last];
+            if (indexes.nameIndex.get(moved.name, named) && named == last)
+                indexes.nameIndex.put(moved.name, idx);
+            indexes.nameTree.replace(moved.name, last, idx);
+            indexes.nameGrams.replace(moved.name, last, idx);
+            indexes.amountIndex.replace(moved.amount, last, idx);
+            indexes.rateIndex.replace(moved.rate, last, idx);
+            indexes.monthsIndex.replace(moved.months, last, idx);
+            indexes.amountRange.replace(moved.amount, last, idx);
+            indexes.rateRange.replace(moved.rate, last, idx);
+            indexes.monthsRange.replace(moved.months, last, idx);
+            indexes.rateBits.replace(moved.rate, last, idx);
+            indexes.monthsBits.replace(moved.months, last, idx);
+            deposits[idx] = std::move(deposits[last]);
+        }
+        deposits.pop_back();
+        if (viewSorted)
+            Utilities::dropFromView(viewOrder, deposits, idx, last, viewBy);
+        else
+            Utilities::dropFromView(viewOrder, idx, last);
+    }
+
+    // ----- update: re-post only the fields that changed -----
+    // no re-sort; a sorted view just moves the one entry
+    void reindexAt(const std::vector<Deposit> &deposits,
+                   std::vector<std::size_t> &viewOrder,
+                   bool (*viewBy)(const Deposit &, const Deposit &),
+                   bool viewSorted,
+                   DepositIndexes &indexes,
+                   std::size_t idx,
+                   const Deposit &before)
+    {
+        const Deposit &now = deposits[idx];
+        if (now.amount != before.amount)
+        {
+            indexes.amountIndex.erase(before.amount, idx);
+            indexes.amountIndex.put(now.amount, idx);
+            indexes.amountRange.erase(before.amount, idx);
+            indexes.amountRange.put(now.amount, idx);
+        }
+        if (now.rate != before.rate)
+        {
+            indexes.rateIndex.erase(before.rate, idx);
+            indexes.rateIndex.put(now.rate, idx);
+            indexes.rateRange.erase(before.rate, idx);
+            indexes.rateRange.put(now.rate, idx);
+            indexes.rateBits.erase(before.rate, idx);
+            indexes.rateBits.put(now.rate, idx);
+        }
+        if (now.months != before.months)
+        {
+            indexes.monthsIndex.erase(before.months, idx);
+            indexes.monthsIndex.put(now.months, idx);
+            indexes.monthsRange.erase(before.months, idx);
+            indexes.monthsRange.put(now.months, idx);
+            indexes.monthsBits.erase(before.months, idx);
+            indexes.monthsBits.put(now.months, idx);
+        }
+
+        if (now.amount != before.amount || now.months != before.months)
+        {
+            indexes.amountByMonths.remove(before.months, before.amount);
+            indexes.amountByMonths.add(now.months, now.amount);
+        }
+        if (now.rate != before.rate || now.months != before.months)
+        {
+            indexes.rateByMonths.remove(before.months, before.rate);
+            indexes.rateByMonths.add(now.months, now.rate);
+        }
+
+        if (viewSorted)
+            Utilities::repositionInView(viewOrder, deposits, idx, before, viewBy);
     }
 
     void showMenu()
     {
         // 1) load from file
         std::vector<Deposit> deposits;
-        Storage::loadDeposits(deposits, "data/deposits.txt");
+        Storage::Journal<Deposit> journal("data/deposits.txt");
+        Storage::LoadInfo loaded;
+        journal.load(deposits, &loaded);
 
         // 2) build all structures once
         std::vector<std::size_t> viewOrder;
-        StringIntMap nameIndex(211);
-        HashMultiMap<double> amountIndex(211);
-        HashMultiMap<double> rateIndex(211);
-        HashMultiMap<int> monthsIndex(211);
-        rebuildAll(deposits, viewOrder, nameIndex, amountIndex, rateIndex, monthsIndex);
+        DepositIndexes indexes;
+        std::vector<IndexSpan> spans; // reused by the "between" searches
+        std::vector<std::size_t> hits; // and the partial-name, filter and top-K ones
+        std::string display; // every view is formatted here, then written at once
+        rebuildAll(deposits, viewOrder, indexes, &loaded);
+        loaded = Storage::LoadInfo(); // only the first build uses it
+
+        // what viewOrder is sorted by; adds append, so it's unsorted until the next sort
+        bool (*viewBy)(const Deposit &, const Deposit &) = DepositSort::byName;
+        bool viewSorted = true;
 
         // recent actions
         DSLinkedList<std::string> recent;
 
         while (true)
         {
+            journal.maybeCompact(deposits);
+
             std::cout << "\n[Deposits]\n"
                       << "1) Add deposit\n"
                       << "2) View deposits\n"
@@ -110,7 +465,9 @@ namespace Deposits
                       << "7) Delete deposit\n"
                       << "8) Load sample data\n"
                       << "9) Reset data\n"
-                      << "10) Back\n"
+                      << "10) Summary\n"
+                      << "11) Page / top K\n"
+                      << "12) Back\n"
                       << "Choices: ";
 
             int ch;
@@ -134,16 +491,15 @@ namespace Deposits
                 std::cin >> d.months;
 
                 deposits.push_back(d);
+                journal.add(d);
                 std::size_t idx = deposits.size() - 1;
 
                 // incremental index updates (O(1))
-                nameIndex.put(d.name, idx);
-                amountIndex.put(d.amount, idx);
-                rateIndex.put(d.rate, idx);
-                monthsIndex.put(d.months, idx);
+                indexes.add(d, idx);
 
                 // view just appends — we sort only when user asks
                 viewOrder.push_back(idx);
+                viewSorted = false;
 
                 double mat = calcMaturity(d);
                 std::cout << "Maturity value: " << mat << "\n";
@@ -152,7 +508,7 @@ namespace Deposits
             }
             else if (ch == 2) // READ
             {
-                displayAll(deposits, viewOrder);
+                displayAll(deposits, viewOrder, display);
             }
             else if (ch == 3) // SORT (expensive, but user-triggered)
             {
@@ -168,19 +524,30 @@ namespace Deposits
                 switch (s)
                 {
                 case 1:
-                    Utilities::quickSortIndices(viewOrder, deposits, DepositSort::byName);
+                    viewBy = DepositSort::byName;
+                    viewSorted = true;
+                    Utilities::sortView(viewOrder, deposits, viewBy, ThreadPool::shared());
                     std::cout << "Sorted by name.\n";
                     break;
                 case 2:
-                    Utilities::quickSortIndices(viewOrder, deposits, DepositSort::byAmount);
+                    viewBy = DepositSort::byAmount;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, deposits, [](const Deposit &d)
+                                             { return d.amount; });
                     std::cout << "Sorted by amount.\n";
                     break;
                 case 3:
-                    Utilities::quickSortIndices(viewOrder, deposits, DepositSort::byRate);
+                    viewBy = DepositSort::byRate;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, deposits, [](const Deposit &d)
+                                             { return d.rate; });
                     std::cout << "Sorted by rate.\n";
                     break;
                 case 4:
-                    Utilities::quickSortIndices(viewOrder, deposits, DepositSort::byMonths);
+                    viewBy = DepositSort::byMonths;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, deposits, [](const Deposit &d)
+                                             { return d.months; });
                     std::cout << "Sorted by months.\n";
                     break;
                 default:
@@ -203,6 +570,12 @@ namespace Deposits
                           << "2) Amount\n"
                           << "3) Rate\n"
                           << "4) Months\n"
+                          << "5) Amount between\n"
+                          << "6) Rate between\n"
+                          << "7) Months between\n"
+                          << "8) Name starts with\n"
+                          << "9) Name contains\n"
+                          << "10) Filter (e.g. months <= 12 AND rate >= 7.5 AND amount > 10000)\n"
                           << "Choice: ";
                 int s;
                 std::cin >> s;
@@ -214,12 +587,8 @@ namespace Deposits
                     std::getline(std::cin >> std::ws, key); // ⭐ supports spaces
 
                     std::size_t idx;
-                    if (nameIndex.get(key, idx))
-                    {
-                        const auto &d = deposits[idx];
-                        std::cout << "Found: " << d.name << " | Amt=" << d.amount
-                                  << " | Rate=" << d.rate << " | Months=" << d.months << "\n";
-                    }
+                    if (indexes.nameIndex.get(key, idx))
+                        displayFound(deposits, IndexSpan{&idx, 1}, display);
                     else
                         std::cout << "Deposit not found.\n";
                 }
@@ -228,17 +597,7 @@ namespace Deposits
                     std::cout << "Enter amount: ";
                     double amt;
                     std::cin >> amt;
-                    std::vector<std::size_t> matches;
-                    if (amountIndex.get(amt, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &d = deposits[idx];
-                            std::cout << "Found: " << d.name << " | Amt=" << d.amount
-                                      << " | Rate=" << d.rate << " | Months=" << d.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(deposits, indexes.amountIndex.get(amt), display))
                         std::cout << "No deposits with that amount.\n";
                 }
                 else if (s == 3)
@@ -246,17 +605,7 @@ namespace Deposits
                     std::cout << "Enter rate: ";
                     double r;
                     std::cin >> r;
-                    std::vector<std::size_t> matches;
-                    if (rateIndex.get(r, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &d = deposits[idx];
-                            std::cout << "Found: " << d.name << " | Amt=" << d.amount
-                                      << " | Rate=" << d.rate << " | Months=" << d.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(deposits, indexes.rateIndex.get(r), display))
                         std::cout << "No deposits with that rate.\n";
                 }
                 else if (s == 4)
@@ -264,19 +613,83 @@ namespace Deposits
                     std::cout << "Enter months: ";
                     int m;
                     std::cin >> m;
-                    std::vector<std::size_t> matches;
-                    if (monthsIndex.get(m, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &d = deposits[idx];
-                            std::cout << "Found: " << d.name << " | Amt=" << d.amount
-                                      << " | Rate=" << d.rate << " | Months=" << d.months << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(deposits, indexes.monthsIndex.get(m), display))
                         std::cout << "No deposits with that tenure.\n";
                 }
+                else if (s == 5)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest amount: ";
+                    std::cin >> lo;
+                    std::cout << "Highest amount: ";
+                    std::cin >> hi;
+                    indexes.amountRange.range(lo, hi, spans);
+                    if (!displayFound(deposits, spans, display))
+                        std::cout << "No deposits with amount in that range.\n";
+                }
+                else if (s == 6)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest rate: ";
+                    std::cin >> lo;
+                    std::cout << "Highest rate: ";
+                    std::cin >> hi;
+                    indexes.rateRange.range(lo, hi, spans);
+                    if (!displayFound(deposits, spans, display))
+                        std::cout << "No deposits with rate in that range.\n";
+                }
+                else if (s == 7)
+                {
+                    int lo, hi;
+                    std::cout << "Lowest months: ";
+                    std::cin >> lo;
+                    std::cout << "Highest months: ";
+                    std::cin >> hi;
+                    indexes.monthsRange.range(lo, hi, spans);
+                    if (!displayFound(deposits, spans, display))
+                        std::cout << "No deposits with months in that range.\n";
+                }
+                else if (s == 8)
+                {
+                    std::cout << "Name starts with: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameTree.withPrefix(part, hits); // already in name order
+                            if (!displayFound(deposits, hits, display))
+                                std::cout << "No deposits with a name that starts with that.\n";
+                }
+                else if (s == 9)
+                {
+                    std::cout << "Name contains: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameGrams.withSubstring(part, deposits, [](const Deposit &d) -> const std::string &
+                                                    { return d.name; },
+                                                    hits);
+                    Utilities::quickSortIndices(hits, deposits, DepositSort::byName, ThreadPool::shared());
+                    if (!displayFound(deposits, hits, display))
+                        std::cout << "No deposits with a name that contains that.\n";
+                }
+                else if (s == 10)
+                {
+                    std::cout << "Filter: ";
+                    std::string text, error;
+                    std::getline(std::cin >> std::ws, text);
+                    std::vector<Query::Condition> conditions;
+                    std::vector<Query::Field> fields(3);
+                    fields[0].name = "amount";
+                    fields[0].doubleRange = &indexes.amountRange;
+                    fields[0].valueOf = [&](std::size_t idx)
+                    { return deposits[idx].amount; };
+                    fields[1].name = "rate";
+                    fields[1].doubleBits = &indexes.rateBits;
+                    fields[2].name = "months";
+                    fields[2].intBits = &indexes.monthsBits;
+                    if (!Query::parse(text, conditions, error) || !Query::run(fields, conditions, hits, error))
+                        std::cout << error << "\n";
+                    else if (!displayFound(deposits, hits, display))
+                        std::cout << "No deposits match that filter.\n";
+                }
                 else
                 {
                     std::cout << "Invalid search option.\n";
@@ -291,20 +704,21 @@ namespace Deposits
                 while (recent.popFront(action))
                     std::cout << action << "\n";
             }
-            else if (ch == 6) // UPDATE (rare → rebuild)
+            else if (ch == 6) // UPDATE (incremental)
             {
                 std::cout << "Enter name to update: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ supports spaces
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
                     auto &d = deposits[idx];
+                    Deposit before = d;
                     std::cout << "New amount (" << d.amount << "): ";
                     std::cin >> d.amount;
                     std::cout << "New rate (" << d.rate << "): ";
@@ -312,28 +726,28 @@ namespace Deposits
                     std::cout << "New months (" << d.months << "): ";
                     std::cin >> d.months;
 
-                    // full rebuild so all indexes stay correct
-                    rebuildAll(deposits, viewOrder, nameIndex, amountIndex, rateIndex, monthsIndex);
+                    // re-post changed fields only
+                    reindexAt(deposits, viewOrder, viewBy, viewSorted, indexes, idx, before);
+                    journal.update(idx, deposits[idx]);
 
                     recent.pushFront("Updated deposit: " + key);
                 }
             }
-            else if (ch == 7) // DELETE (rare → rebuild)
+            else if (ch == 7) // DELETE (swap-and-pop)
             {
                 std::cout << "Enter name to delete: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ supports spaces
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
-                    deposits.erase(deposits.begin() + idx);
-                    // rebuild everything to fix shifted indices
-                    rebuildAll(deposits, viewOrder, nameIndex, amountIndex, rateIndex, monthsIndex);
+                    journal.remove(idx);
+                    removeAt(deposits, viewOrder, viewBy, viewSorted, indexes, idx);
                     recent.pushFront("Deleted deposit: " + key);
                     std::cout << "Deleted.\n";
                 }
@@ -343,7 +757,10 @@ namespace Deposits
                 std::vector<Deposit> sample;
                 Storage::loadDeposits(sample, "data/deposits_sample.txt");
                 deposits = sample;
-                rebuildAll(deposits, viewOrder, nameIndex, amountIndex, rateIndex, monthsIndex);
+                journal.replaceAll(deposits);
+                rebuildAll(deposits, viewOrder, indexes);
+                viewBy = DepositSort::byName;
+                viewSorted = true;
                 recent.pushFront("Loaded sample deposits");
                 std::cout << "Sample deposits loaded.\n";
             }
@@ -351,23 +768,68 @@ namespace Deposits
             {
                 deposits.clear();
                 viewOrder.clear();
-                nameIndex = StringIntMap(211);
-                amountIndex.clear();
-                rateIndex.clear();
-                monthsIndex.clear();
-                std::vector<Deposit> empty;
-                Storage::saveDeposits(empty, "data/deposits.txt");
+                viewSorted = true;
+                indexes.clear();
+                journal.replaceAll(deposits);
                 recent.pushFront("Reset deposit data");
                 std::cout << "All deposit data reset.\n";
             }
+            else if (ch == 10) // summary (running totals)
+            {
+                std::cout << "Group by:\n"
+                          << "1) Months\n"
+                          << "2) Rate\n"
+                          << "Choice: ";
+                int g;
+                std::cin >> g;
+                displaySummary(deposits, indexes.amountByMonths, indexes.rateByMonths, indexes.amountRange, g == 2);
+            }
+            else if (ch == 11) // page of the view, or top K
+            {
+                std::cout << "1) Page of the current view\n"
+                          << "2) Top K by amount\n"
+                          << "3) Top K by rate\n"
+                          << "4) Top K by months\n"
+                          << "Choice: ";
+                int v;
+                std::cin >> v;
+                if (v == 1)
+                {
+                    std::size_t offset = 0, limit = 0;
+                    std::cout << "First row (from 0): ";
+                    std::cin >> offset;
+                    std::cout << "Rows: ";
+                    std::cin >> limit;
+                    displayAll(deposits, viewOrder, display, offset, limit);
+                }
+                else if (v >= 2 && v <= 4)
+                {
+                    std::size_t k = 0;
+                    std::cout << "K: ";
+                    std::cin >> k;
+                    // largest first; no full sort
+                    if (v == 2)
+                        Utilities::topKIndices(hits, deposits, k, [](const Deposit &a, const Deposit &b)
+                                               { return DepositSort::byAmount(b, a); });
+                    else if (v == 3)
+                        Utilities::topKIndices(hits, deposits, k, [](const Deposit &a, const Deposit &b)
+                                               { return DepositSort::byRate(b, a); });
+                    else if (v == 4)
+                        Utilities::topKIndices(hits, deposits, k, [](const Deposit &a, const Deposit &b)
+                                               { return DepositSort::byMonths(b, a); });
+                    displayAll(deposits, hits, display);
+                }
+                else
+                    std::cout << "Invalid view option.\n";
+            }
             else
             {
                 break;
             }
         }
 
-        // save on exit
-        Storage::saveDeposits(deposits, "data/deposits.txt");
+        // snapshot on exit, skipped when nothing changed
+        journal.checkpoint(deposits);
     }
 
 } // namespace Deposits
@@ -2,11 +2,18 @@
 #include "loans.hpp"
 #include "storage.hpp"
 #include "ds_hash.hpp"
+#include "ds_range.hpp"
+#include "ds_trie.hpp"
+#include "query.hpp"
+#include "aggregate.hpp"
 #include "ds_linked_list.hpp"
+#include "rate_kernels.hpp"
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <string>
+#include <charconv>
+#include <cstdio>
 
 namespace Loans
 {
@@ -25,25 +32,428 @@ namespace Loans
     {
         double monthlyRate = loan.rate / (12 * 100);
         int months = loan.years * 12;
-        return (loan.principal * monthlyRate * std::pow(1 + monthlyRate, months)) /
-               (std::pow(1 + monthlyRate, months) - 1);
+        double growth = std::pow(1 + monthlyRate, months);
+        return (loan.principal * monthlyRate * growth) / (growth - 1);
     }
 
-    // ----- display -----
+    // batch versions: the growth factors come from RateKernels, then
+    // the same closing formula as above
+    void calcCompound(const double *principal, const double *rate, const int *years,
+                      std::size_t n, double *out)
+    {
+        RateKernels::growth(rate, 100.0, years, 1, n, out);
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = principal[i] * (out[i] - 1);
+    }
+
+    void calcEMI(const double *principal, const double *rate, const int *years,
+                 std::size_t n, double *out)
+    {
+        RateKernels::growth(rate, 12 * 100, years, 12, n, out);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            double monthlyRate = rate[i] / (12 * 100);
+            out[i] = (principal[i] * monthlyRate * out[i]) / (out[i] - 1);
+        }
+    }
+
+    // same formulas over the columns; each loop reads only the
+    // numeric columns it needs
+    void calcSimple(const LoanTable &t, std::vector<double> &out)
+    {
+        out.resize(t.size());
+        for (std::size_t i = 0; i < t.size(); ++i)
+            out[i] = t.principal[i] * t.rate[i] * t.years[i] / 100.0;
+    }
+
+    void calcCompound(const LoanTable &t, std::vector<double> &out)
+    {
+        out.resize(t.size());
+        calcCompound(t.principal.data(), t.rate.data(), t.years.data(), t.size(), out.data());
+    }
+
+    void calcEMI(const LoanTable &t, std::vector<double> &out)
+    {
+        out.resize(t.size());
+        calcEMI(t.principal.data(), t.rate.data(), t.years.data(), t.size(), out.data());
+    }
+
+    // ----- amortization -----
+    namespace
+    {
+        // emit(month, payment, interest, principal, balance) for each month
+        template <typename Emit>
+        void amortize(double principal, double rate, int years, Emit emit)
+        {
+            int months = static_cast<int>(scheduleLength(years));
+            if (months == 0)
+                return;
+            double monthlyRate = rate / (12 * 100);
+            double payment = principal / months;
+            if (monthlyRate != 0)
+            {
+                double growth = std::pow(1 + monthlyRate, months);
+                payment = (principal * monthlyRate * growth) / (growth - 1);
+            }
+
+            double balance = principal;
+            for (int m = 1; m < months; ++m)
+            {
+                double interest = balance * monthlyRate;
+                double paid = payment - interest;
+                balance -= paid;
+                emit(m, payment, interest, paid, balance);
+            }
+            double interest = balance * monthlyRate;
+            emit(months, balance + interest, interest, balance, 0.0);
+        }
+
+        // Cuts loans [first, last) into runs of about SCHEDULE_PIECE_ROWS
+        // rows: piece(begin, end, firstRow) per run, in order
+        template <typename Piece>
+        void forEachPiece(const LoanTable &t, std::size_t first, std::size_t last, Piece piece)
+        {
+            std::size_t begin = first, rows = 0, firstRow = 0;
+            for (std::size_t i = first; i < last; ++i)
+            {
+                rows += scheduleLength(t.years[i]);
+                if (rows >= SCHEDULE_PIECE_ROWS || i + 1 == last)
+                {
+                    piece(begin, i + 1, firstRow);
+                    begin = i + 1;
+                    firstRow += rows;
+                    rows = 0;
+                }
+            }
+        }
+
+        constexpr std::size_t FIXED_MAX = 400; // any double in fixed notation
+
+        // ",123.45" at p: two decimals, the digits printf("%.2f") gives.
+        // Below 2^52 cents they are rounded here: c = v * 100 plus its
+        // exact rounding error (Dekker, 100 needs no split) decides ties.
+        char *putFixed(char *p, double v)
+        {
+            *p++ = ',';
+            double a = std::fabs(v);
+            if (!(a < 4.5e13))
+            {
+#if defined(__cpp_lib_to_chars)
+                auto r = std::to_chars(p, p + FIXED_MAX, v, std::chars_format::fixed, 2);
+                return r.ec == std::errc() ? r.ptr : p;
+#else
+                return p + std::snprintf(p, FIXED_MAX, "%.2f", v);
+#endif
+            }
+            const double split = 134217729.0; // 2^27 + 1
+            double c = a * 100;
+            double t = split * a, hi = t - (t - a), lo = a - hi;
+            double err = (hi * 100 - c) + lo * 100; // a * 100 = c + err exactly
+            auto cents = static_cast<long long>(c);
+            double half = (c - static_cast<double>(cents)) - 0.5;
+            if (half > 0 || (half == 0 && (err > 0 || (err == 0 && (cents & 1)))))
+                ++cents;
+
+            if (std::signbit(v))
+                *p++ = '-';
+            long long whole = cents / 100;
+            int frac = static_cast<int>(cents - whole * 100);
+            p = std::to_chars(p, p + 24, whole).ptr;
+            p[0] = '.';
+            p[1] = static_cast<char>('0' + frac / 10);
+            p[2] = static_cast<char>('0' + frac % 10);
+            return p + 3;
+        }
+
+        // CSV field: quoted only when it has to be
+        void appendField(std::string &out, const std::string &s)
+        {
+            if (s.find_first_of(",\"\n") == std::string::npos)
+            {
+                out += s;
+                return;
+            }
+            out += '"';
+            for (char ch : s)
+            {
+                if (ch == '"')
+                    out += '"';
+                out += ch;
+            }
+            out += '"';
+        }
+
+        // CSV rows of the schedules of loans [begin, end)
+        void appendScheduleCsv(std::string &text, const LoanTable &t, std::size_t begin, std::size_t end)
+        {
+            std::string name;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                name.clear();
+                appendField(name, t.name[i]);
+                name += ',';
+                amortize(t.principal[i], t.rate[i], t.years[i],
+                         [&](int month, double payment, double interest, double paid, double balance)
+                         {
+                             char row[16 + 4 * FIXED_MAX];
+                             char *p = std::to_chars(row, row + 16, month).ptr;
+                             p = putFixed(p, payment);
+                             p = putFixed(p, interest);
+                             p = putFixed(p, paid);
+                             p = putFixed(p, balance);
+                             *p++ = '\n';
+                             text += name;
+                             text.append(row, p);
+                         });
+            }
+        }
+    }
+
+    std::size_t scheduleLength(int years)
+    {
+        return years > 0 ? static_cast<std::size_t>(years) * 12 : 0;
+    }
+
+    void schedule(std::size_t loan, double principal, double rate, int years, ScheduleRow *out)
+    {
+        amortize(principal, rate, years, [&](int month, double payment, double interest, double paid, double balance)
+                 { *out++ = ScheduleRow{loan, month, payment, interest, paid, balance}; });
+    }
+
+    std::size_t scheduleRows(const LoanTable &t, std::size_t first, std::size_t last)
+    {
+        std::size_t rows = 0;
+        for (std::size_t i = first; i < last; ++i)
+            rows += scheduleLength(t.years[i]);
+        return rows;
+    }
+
+    void schedules(const LoanTable &t, std::size_t first, std::size_t last, ScheduleRow *out,
+                   ThreadPool &pool)
+    {
+        TaskGroup group(pool);
+        forEachPiece(t, first, last, [&](std::size_t begin, std::size_t end, std::size_t firstRow)
+                     { group.run([&t, begin, end, row = out + firstRow]() mutable
+                                 {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    schedule(i, t.principal[i], t.rate[i], t.years[i], row);
+                    row += scheduleLength(t.years[i]);
+                } }); });
+        group.wait();
+    }
+
+    ScheduleWriter::ScheduleWriter(std::ostream &out, ThreadPool &pool)
+        : out_(out), pool_(pool)
+    {
+        out_ << "name,month,payment,interest,principal,balance\n";
+    }
+
+    bool ScheduleWriter::write(const LoanTable &t)
+    {
+        // a round is one piece per buffer: formatted in parallel, then written in order
+        const std::size_t perRound = 2 * pool_.threadCount();
+        if (pieces_.size() < perRound)
+            pieces_.resize(perRound);
+        std::vector<std::pair<std::size_t, std::size_t>> round;
+
+        auto writeRound = [&]()
+        {
+            TaskGroup group(pool_);
+            for (std::size_t k = 0; k < round.size(); ++k)
+                group.run([this, &t, &round, k]()
+                          {
+                pieces_[k].clear();
+                appendScheduleCsv(pieces_[k], t, round[k].first, round[k].second); });
+            group.wait();
+            for (std::size_t k = 0; k < round.size(); ++k)
+                out_.write(pieces_[k].data(), static_cast<std::streamsize>(pieces_[k].size()));
+            round.clear();
+        };
+
+        forEachPiece(t, 0, t.size(), [&](std::size_t begin, std::size_t end, std::size_t)
+                     {
+            round.emplace_back(begin, end);
+            if (round.size() == perRound)
+                writeRound(); });
+        writeRound();
+        rows_ += scheduleRows(t, 0, t.size());
+        return static_cast<bool>(out_);
+    }
+
+    // ----- display rows [offset, offset + limit) of a view -----
+    // formatted into one reusable buffer, written a page at a time
     void displayAll(const std::vector<Loan> &loans,
-                    const std::vector<std::size_t> &order)
+                    const std::vector<std::size_t> &order,
+                    std::string &buffer,
+                    std::size_t offset = 0,
+                    std::size_t limit = SIZE_MAX)
+    {
+        auto [first, last] = Utilities::pageOf(order.size(), offset, limit);
+        buffer.clear();
+        buffer += "\n--- Loans ---\n";
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const auto &l = loans[order[i]];
+            buffer += l.name;
+            buffer += " | Principal=";
+            Utilities::appendNumber(buffer, l.principal);
+            buffer += " | Rate=";
+            Utilities::appendNumber(buffer, l.rate);
+            buffer += " | Years=";
+            Utilities::appendNumber(buffer, l.years);
+            buffer += '\n';
+            if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                Utilities::writeOut(buffer);
+        }
+        Utilities::writeOut(buffer);
+    }
+
+    // ----- search results: a "Found:" line per row, buffered like displayAll -----
+    // false (and nothing printed) when there are no rows
+    bool displayFound(const std::vector<Loan> &loans, const IndexSpan *spans, std::size_t count, std::string &buffer)
+    {
+        std::size_t shown = 0;
+        buffer.clear();
+        for (std::size_t s = 0; s < count; ++s)
+            for (std::size_t idx : spans[s])
+            {
+                const auto &l = loans[idx];
+                buffer += "Found: ";
+                buffer += l.name;
+                buffer += " | Principal=";
+                Utilities::appendNumber(buffer, l.principal);
+                buffer += " | Rate=";
+                Utilities::appendNumber(buffer, l.rate);
+                buffer += " | Years=";
+                Utilities::appendNumber(buffer, l.years);
+                buffer += '\n';
+                ++shown;
+                if (buffer.size() >= Utilities::OUTPUT_FLUSH_BYTES)
+                    Utilities::writeOut(buffer);
+            }
+        Utilities::writeOut(buffer);
+        return shown > 0;
+    }
+
+    bool displayFound(const std::vector<Loan> &loans, IndexSpan rows, std::string &buffer)
+    {
+        return displayFound(loans, &rows, 1, buffer);
+    }
+
+    // a RangeIndex result
+    bool displayFound(const std::vector<Loan> &loans, const std::vector<IndexSpan> &spans, std::string &buffer)
     {
-        std::cout << "\n--- Loans ---\n";
-        for (std::size_t idx : order)
+        return displayFound(loans, spans.data(), spans.size(), buffer);
+    }
+
+    bool displayFound(const std::vector<Loan> &loans, const std::vector<std::size_t> &rows, std::string &buffer)
+    {
+        return displayFound(loans, IndexSpan{rows.data(), rows.size()}, buffer);
+    }
+
+    // ----- summary: overall and per group -----
+    // grouped by years it reads the running totals, O(groups); by rate
+    // it is one Aggregate::groupBy pass over two columns
+    void displaySummary(const std::vector<Loan> &loans,
+                        const RunningTotals<int> &principalByYears,
+                        const RunningTotals<int> &rateByYears,
+                        const RangeIndex<double> &principalRange,
+                        bool byRate)
+    {
+        std::cout << "\n--- Loan summary ---\n"
+                  << "Loans=" << principalByYears.count()
+                  << " | Total principal=" << principalByYears.sum()
+                  << " | Avg principal=" << principalByYears.mean();
+        if (principalRange.size() > 0)
+            std::cout << " | Min principal=" << principalRange.minKey()
+                      << " | Max principal=" << principalRange.maxKey();
+        std::cout << " | Avg rate=" << rateByYears.mean() << "\n";
+
+        if (byRate)
+        {
+            std::vector<double> rate(loans.size()), principal(loans.size());
+            for (std::size_t i = 0; i < loans.size(); ++i)
+            {
+                rate[i] = loans[i].rate;
+                principal[i] = loans[i].principal;
+            }
+            std::vector<Aggregate::Group<double>> groups;
+            Aggregate::groupBy(rate, principal, groups);
+            for (const auto &g : groups)
+                std::cout << "Rate=" << g.key
+                          << " | Count=" << g.summary.count
+                          << " | Principal=" << g.summary.sum
+                          << " | Avg principal=" << g.summary.mean()
+                          << " | Min principal=" << g.summary.min
+                          << " | Max principal=" << g.summary.max << "\n";
+            return;
+        }
+        for (std::size_t g = 0; g < principalByYears.groups(); ++g)
         {
-            const auto &l = loans[idx];
-            std::cout << l.name
-                      << " | Principal=" << l.principal
-                      << " | Rate=" << l.rate
-                      << " | Years=" << l.years << "\n";
+            int years = principalByYears.key(g);
+            std::cout << "Years=" << years
+                      << " | Count=" << principalByYears.count(g)
+                      << " | Principal=" << principalByYears.sum(g)
+                      << " | Avg principal=" << principalByYears.mean(g)
+                      << " | Avg rate=" << rateByYears.mean(rateByYears.find(years)) << "\n";
         }
     }
 
+    // ----- every index of the book, in one place -----
+    // rebuildAll builds them, add / removeAt / reindexAt keep them current
+    struct LoanIndexes
+    {
+        StringIntMap nameIndex{101};
+        RadixTree nameTree;     // "starts with" searches
+        TrigramIndex nameGrams; // "contains" searches
+        HashMultiMap<double> principalIndex{101};
+        HashMultiMap<double> rateIndex{101};
+        HashMultiMap<int> yearsIndex{101};
+        RangeIndex<double> principalRange;
+        RangeIndex<double> rateRange;
+        RangeIndex<int> yearsRange;
+        BitmapIndex<double> rateBits; // filter queries
+        BitmapIndex<int> yearsBits;
+        RunningTotals<int> principalByYears; // the summary
+        RunningTotals<int> rateByYears;
+
+        // a record appended at idx
+        void add(const Loan &l, std::size_t idx)
+        {
+            nameIndex.put(l.name, idx);
+            nameTree.put(l.name, idx);
+            nameGrams.put(l.name, idx);
+            principalIndex.put(l.principal, idx);
+            rateIndex.put(l.rate, idx);
+            yearsIndex.put(l.years, idx);
+            principalRange.put(l.principal, idx);
+            rateRange.put(l.rate, idx);
+            yearsRange.put(l.years, idx);
+            rateBits.put(l.rate, idx);
+            yearsBits.put(l.years, idx);
+            principalByYears.add(l.years, l.principal);
+            rateByYears.add(l.years, l.rate);
+        }
+
+        void clear()
+        {
+            nameIndex = StringIntMap(101);
+            nameTree.clear();
+            nameGrams.clear();
+            principalIndex.clear();
+            rateIndex.clear();
+            yearsIndex.clear();
+            principalRange.clear();
+            rateRange.clear();
+            yearsRange.clear();
+            rateBits.clear();
+            yearsBits.clear();
+            principalByYears.clear();
+            rateByYears.clear();
+        }
+    };
+
     // ----- rebuild value indexes -----
     void rebuildValueIndexes(
         const std::vector<Loan> &loans,
@@ -51,58 +461,234 @@ namespace Loans
         HashMultiMap<double> &rateIndex,
         HashMultiMap<int> &yearsIndex)
     {
-        principalIndex.clear();
-        rateIndex.clear();
-        yearsIndex.clear();
-        for (std::size_t i = 0; i < loans.size(); ++i)
-        {
-            principalIndex.put(loans[i].principal, i);
-            rateIndex.put(loans[i].rate, i);
-            yearsIndex.put(loans[i].years, i);
-        }
+        principalIndex.build(loans.begin(), loans.end(),
+                             [](const Loan &l)
+                             { return l.principal; });
+        rateIndex.build(loans.begin(), loans.end(),
+                        [](const Loan &l)
+                        { return l.rate; });
+        yearsIndex.build(loans.begin(), loans.end(),
+                         [](const Loan &l)
+                         { return l.years; });
+    }
+
+    // ----- rebuild ordered indexes (the "between" searches) -----
+    void rebuildRangeIndexes(
+        const std::vector<Loan> &loans,
+        RangeIndex<double> &principalRange,
+        RangeIndex<double> &rateRange,
+        RangeIndex<int> &yearsRange)
+    {
+        principalRange.build(loans,
+                             [](const Loan &l)
+                             { return l.principal; });
+        rateRange.build(loans,
+                        [](const Loan &l)
+                        { return l.rate; });
+        yearsRange.build(loans,
+                         [](const Loan &l)
+                         { return l.years; });
+    }
+
+    // ----- rebuild bitmap indexes (the filter queries) -----
+    void rebuildBitmapIndexes(
+        const std::vector<Loan> &loans,
+        BitmapIndex<double> &rateBits,
+        BitmapIndex<int> &yearsBits)
+    {
+        rateBits.build(loans,
+                       [](const Loan &l)
+                       { return l.rate; });
+        yearsBits.build(loans,
+                        [](const Loan &l)
+                        { return l.years; });
+    }
+
+    // ----- rebuild running totals (the summary) -----
+    void rebuildTotals(
+        const std::vector<Loan> &loans,
+        RunningTotals<int> &principalByYears,
+        RunningTotals<int> &rateByYears)
+    {
+        principalByYears.build(loans,
+                               [](const Loan &l)
+                               { return l.years; },
+                               [](const Loan &l)
+                               { return l.principal; });
+        rateByYears.build(loans,
+                          [](const Loan &l)
+                          { return l.years; },
+                          [](const Loan &l)
+                          { return l.rate; });
     }
 
     // ----- full rebuild -----
-    void rebuildAll(std::vector<Loan> &loans,
+    void rebuildAll(const std::vector<Loan> &loans,
                     std::vector<std::size_t> &viewOrder,
-                    StringIntMap &nameIndex,
-                    HashMultiMap<double> &principalIndex,
-                    HashMultiMap<double> &rateIndex,
-                    HashMultiMap<int> &yearsIndex)
+                    LoanIndexes &indexes,
+                    const Storage::LoadInfo *loaded = nullptr)
     {
-        Utilities::quickSort(loans, LoanBy::byName);
-
         viewOrder.clear();
         viewOrder.reserve(loans.size());
         for (std::size_t i = 0; i < loans.size(); ++i)
             viewOrder.push_back(i);
-        Utilities::quickSortIndices(viewOrder, loans, LoanBy::byName);
+        Utilities::sortView(viewOrder, loans, LoanBy::byName, ThreadPool::shared());
 
-        nameIndex = StringIntMap(101);
-        for (std::size_t i = 0; i < loans.size(); ++i)
-            nameIndex.put(loans[i].name, i);
+        indexes.nameIndex.build(loans.begin(), loans.end(),
+                                [](const Loan &l) -> const std::string &
+                                { return l.name; },
+                                loaded ? loaded->nameHashes(loans.size()) : nullptr, loaded ? loaded->nameBytes : 0);
+        indexes.nameTree.build(loans, viewOrder,
+                               [](const Loan &l) -> const std::string &
+                               { return l.name; });
+        indexes.nameGrams.build(loans,
+                                [](const Loan &l) -> const std::string &
+                                { return l.name; });
+
+        rebuildValueIndexes(loans, indexes.principalIndex, indexes.rateIndex, indexes.yearsIndex);
+        rebuildRangeIndexes(loans, indexes.principalRange, indexes.rateRange, indexes.yearsRange);
+        rebuildBitmapIndexes(loans, indexes.rateBits, indexes.yearsBits);
+        rebuildTotals(loans, indexes.principalByYears, indexes.rateByYears);
+    }
+
+    // ----- delete: swap-and-pop, patch only the touched index entries -----
+    // the last record moves into idx, so its postings are renamed
+    // last -> idx; nothing is re-sorted or rebuilt
+    void removeAt(std::vector<Loan> &loans,
+                  std::vector<std::size_t> &viewOrder,
+                  bool (*viewBy)(const Loan &, const Loan &),
+                  bool viewSorted,
+                  LoanIndexes &indexes,
+                  std::size_t idx)
+    {
+        std::size_t last = loans.size() - 1;
+        const Loan &gone = loans[idx];
+        indexes.nameTree.erase(gone.name, idx);
+        std::size_t named;
+        if (indexes.nameIndex.get(gone.name, named) && named == idx)
+        {
+            // names may repeat: hand the name to another record that has it
+            IndexSpan same = indexes.nameTree.rowsOf(gone.name);
+            if (same.empty())
+                indexes.nameIndex.erase(gone.name);
+            else
+                indexes.nameIndex.put(gone.name, same[0]);
+        }
+        indexes.nameGrams.erase(gone.name, idx);
+        indexes.principalIndex.erase(gone.principal, idx);
+        indexes.rateIndex.erase(gone.rate, idx);
+        indexes.yearsIndex.erase(gone.years, idx);
+        indexes.principalRange.erase(gone.principal, idx);
+        indexes.rateRange.erase(gone.rate, idx);
+        indexes.yearsRange.erase(gone.years, idx);
+        indexes.rateBits.erase(gone.rate, idx);
+        indexes.yearsBits.erase(gone.years, idx);
+        indexes.principalByYears.remove(gone.years, gone.principal);
+        indexes.rateByYears.remove(gone.years, gone.rate);
+
+        if (idx != last)
+        {
+            const Loan &moved = loans[last];
+            if (indexes.nameIndex.get(moved.name, named) && named == last)
+                indexes.nameIndex.put(moved.name, idx);
+            indexes.nameTree.replace(moved.name, last, idx);
+            indexes.nameGrams.replace(moved.name, last, idx);
+            indexes.principalIndex.replace(moved.principal, last, idx);
+            indexes.rateIndex.replace(moved.rate, last, idx);
+            indexes.yearsIndex.replace(moved.years, last, idx);
+            indexes.principalRange.replace(moved.principal, last, idx);
+            indexes.rateRange.replace(moved.rate, last, idx);
+            indexes.yearsRange.replace(moved.years, last, idx);
+            indexes.rateBits.replace(moved.rate, last, idx);
+            indexes.yearsBits.replace(moved.years, last, idx);
+            loans[idx] = std::move(loans[last]);
+        }
+        loans.pop_back();
+        if (viewSorted)
+            Utilities::dropFromView(viewOrder, loans, idx, last, viewBy);
+        else
+            Utilities::dropFromView(viewOrder, idx, last);
+    }
+
+    // ----- update: re-post only the fields that changed -----
+    // no re-sort; a sorted view just moves the one entry
+    void reindexAt(const std::vector<Loan> &loans,
+                   std::vector<std::size_t> &viewOrder,
+                   bool (*viewBy)(const Loan &, const Loan &),
+                   bool viewSorted,
+                   LoanIndexes &indexes,
+                   std::size_t idx,
+                   const Loan &before)
+    {
+        const Loan &now = loans[idx];
+        if (now.principal != before.principal)
+        {
+            indexes.principalIndex.erase(before.principal, idx);
+            indexes.principalIndex.put(now.principal, idx);
+            indexes.principalRange.erase(before.principal, idx);
+            indexes.principalRange.put(now.principal, idx);
+        }
+        if (now.rate != before.rate)
+        {
+            indexes.rateIndex.erase(before.rate, idx);
+            indexes.rateIndex.put(now.rate, idx);
+            indexes.rateRange.erase(before.rate, idx);
+            indexes.rateRange.put(now.rate, idx);
+            indexes.rateBits.erase(before.rate, idx);
+            indexes.rateBits.put(now.rate, idx);
+        }
+        if (now.years != before.years)
+        {
+            indexes.yearsIndex.erase(before.years, idx);
+            indexes.yearsIndex.put(now.years, idx);
+            indexes.yearsRange.erase(before.years, idx);
+            indexes.yearsRange.put(now.years, idx);
+            indexes.yearsBits.erase(before.years, idx);
+            indexes.yearsBits.put(now.years, idx);
+        }
 
-        rebuildValueIndexes(loans, principalIndex, rateIndex, yearsIndex);
+        if (now.principal != before.principal || now.years != before.years)
+        {
+            indexes.principalByYears.remove(before.years, before.principal);
+            indexes.principalByYears.add(now.years, now.principal);
+        }
+        if (now.rate != before.rate || now.years != before.years)
+        {
+            indexes.rateByYears.remove(before.years, before.rate);
+            indexes.rateByYears.add(now.years, now.rate);
+        }
+
+        if (viewSorted)
+            Utilities::repositionInView(viewOrder, loans, idx, before, viewBy);
     }
 
     void showMenu()
     {
         // load
         std::vector<Loan> loans;
-        Storage::loadLoans(loans, "data/loans.txt");
+        Storage::Journal<Loan> journal("data/loans.txt");
+        Storage::LoadInfo loaded;
+        journal.load(loans, &loaded);
 
         // build
         std::vector<std::size_t> viewOrder;
-        StringIntMap nameIndex(101);
-        HashMultiMap<double> principalIndex(101);
-        HashMultiMap<double> rateIndex(101);
-        HashMultiMap<int> yearsIndex(101);
-        rebuildAll(loans, viewOrder, nameIndex, principalIndex, rateIndex, yearsIndex);
+        LoanIndexes indexes;
+        std::vector<IndexSpan> spans; // reused by the "between" searches
+        std::vector<std::size_t> hits; // and the partial-name, filter and top-K ones
+        std::string display; // every view is formatted here, then written at once
+        rebuildAll(loans, viewOrder, indexes, &loaded);
+        loaded = Storage::LoadInfo(); // only the first build uses it
+
+        // what viewOrder is sorted by; adds append, so it's unsorted until the next sort
+        bool (*viewBy)(const Loan &, const Loan &) = LoanBy::byName;
+        bool viewSorted = true;
 
         DSLinkedList<std::string> recent;
 
         while (true)
         {
+            journal.maybeCompact(loans);
+
             std::cout << "\n[Loans]\n"
                       << "1) Add loan\n"
                       << "2) View loans\n"
@@ -112,7 +698,9 @@ namespace Loans
                       << "6) Delete loan\n"
                       << "7) Load sample data\n"
                       << "8) Reset data\n"
-                      << "9) Back\n"
+                      << "9) Summary\n"
+                      << "10) Page / top K\n"
+                      << "11) Back\n"
                       << "Choice: ";
 
             int ch;
@@ -137,14 +725,13 @@ namespace Loans
                 std::cin >> l.years;
 
                 loans.push_back(l);
+                journal.add(l);
                 std::size_t idx = loans.size() - 1;
 
-                nameIndex.put(l.name, idx);
-                principalIndex.put(l.principal, idx);
-                rateIndex.put(l.rate, idx);
-                yearsIndex.put(l.years, idx);
+                indexes.add(l, idx);
 
                 viewOrder.push_back(idx);
+                viewSorted = false;
 
                 std::cout << "Simple Interest: " << calcSimple(l) << "\n";
                 std::cout << "Compound Interest: " << calcCompound(l) << "\n";
@@ -154,7 +741,7 @@ namespace Loans
             }
             else if (ch == 2)
             {
-                displayAll(loans, viewOrder);
+                displayAll(loans, viewOrder, display);
             }
             else if (ch == 3) // sort view
             {
@@ -170,19 +757,30 @@ namespace Loans
                 switch (s)
                 {
                 case 1:
-                    Utilities::quickSortIndices(viewOrder, loans, LoanBy::byName);
+                    viewBy = LoanBy::byName;
+                    viewSorted = true;
+                    Utilities::sortView(viewOrder, loans, viewBy, ThreadPool::shared());
                     std::cout << "Sorted by name.\n";
                     break;
                 case 2:
-                    Utilities::quickSortIndices(viewOrder, loans, LoanBy::byPrincipal);
+                    viewBy = LoanBy::byPrincipal;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, loans, [](const Loan &l)
+                                             { return l.principal; });
                     std::cout << "Sorted by principal.\n";
                     break;
                 case 3:
-                    Utilities::quickSortIndices(viewOrder, loans, LoanBy::byRate);
+                    viewBy = LoanBy::byRate;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, loans, [](const Loan &l)
+                                             { return l.rate; });
                     std::cout << "Sorted by rate.\n";
                     break;
                 case 4:
-                    Utilities::quickSortIndices(viewOrder, loans, LoanBy::byYears);
+                    viewBy = LoanBy::byYears;
+                    viewSorted = true;
+                    Utilities::radixSortView(viewOrder, loans, [](const Loan &l)
+                                             { return l.years; });
                     std::cout << "Sorted by years.\n";
                     break;
                 default:
@@ -205,6 +803,12 @@ namespace Loans
                           << "2) Principal\n"
                           << "3) Rate\n"
                           << "4) Years\n"
+                          << "5) Principal between\n"
+                          << "6) Rate between\n"
+                          << "7) Years between\n"
+                          << "8) Name starts with\n"
+                          << "9) Name contains\n"
+                          << "10) Filter (e.g. years <= 5 AND rate >= 7.5 AND principal > 10000)\n"
                           << "Choice: ";
                 int s;
                 std::cin >> s;
@@ -216,14 +820,8 @@ namespace Loans
                     std::getline(std::cin >> std::ws, key); // ⭐ FIXED
 
                     std::size_t idx;
-                    if (nameIndex.get(key, idx))
-                    {
-                        const auto &l = loans[idx];
-                        std::cout << "Found: " << l.name
-                                  << " | Principal=" << l.principal
-                                  << " | Rate=" << l.rate
-                                  << " | Years=" << l.years << "\n";
-                    }
+                    if (indexes.nameIndex.get(key, idx))
+                        displayFound(loans, IndexSpan{&idx, 1}, display);
                     else
                         std::cout << "Loan not found.\n";
                 }
@@ -232,19 +830,7 @@ namespace Loans
                     std::cout << "Enter principal: ";
                     double p;
                     std::cin >> p;
-                    std::vector<std::size_t> matches;
-                    if (principalIndex.get(p, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &l = loans[idx];
-                            std::cout << "Found: " << l.name
-                                      << " | Principal=" << l.principal
-                                      << " | Rate=" << l.rate
-                                      << " | Years=" << l.years << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(loans, indexes.principalIndex.get(p), display))
                         std::cout << "No loans with that principal.\n";
                 }
                 else if (s == 3)
@@ -252,19 +838,7 @@ namespace Loans
                     std::cout << "Enter rate: ";
                     double r;
                     std::cin >> r;
-                    std::vector<std::size_t> matches;
-                    if (rateIndex.get(r, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &l = loans[idx];
-                            std::cout << "Found: " << l.name
-                                      << " | Principal=" << l.principal
-                                      << " | Rate=" << l.rate
-                                      << " | Years=" << l.years << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(loans, indexes.rateIndex.get(r), display))
                         std::cout << "No loans with that rate.\n";
                 }
                 else if (s == 4)
@@ -272,38 +846,101 @@ namespace Loans
                     std::cout << "Enter years: ";
                     int y;
                     std::cin >> y;
-                    std::vector<std::size_t> matches;
-                    if (yearsIndex.get(y, matches))
-                    {
-                        for (auto idx : matches)
-                        {
-                            const auto &l = loans[idx];
-                            std::cout << "Found: " << l.name
-                                      << " | Principal=" << l.principal
-                                      << " | Rate=" << l.rate
-                                      << " | Years=" << l.years << "\n";
-                        }
-                    }
-                    else
+                    if (!displayFound(loans, indexes.yearsIndex.get(y), display))
                         std::cout << "No loans with that tenure.\n";
                 }
+                else if (s == 5)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest principal: ";
+                    std::cin >> lo;
+                    std::cout << "Highest principal: ";
+                    std::cin >> hi;
+                    indexes.principalRange.range(lo, hi, spans);
+                    if (!displayFound(loans, spans, display))
+                        std::cout << "No loans with principal in that range.\n";
+                }
+                else if (s == 6)
+                {
+                    double lo, hi;
+                    std::cout << "Lowest rate: ";
+                    std::cin >> lo;
+                    std::cout << "Highest rate: ";
+                    std::cin >> hi;
+                    indexes.rateRange.range(lo, hi, spans);
+                    if (!displayFound(loans, spans, display))
+                        std::cout << "No loans with rate in that range.\n";
+                }
+                else if (s == 7)
+                {
+                    int lo, hi;
+                    std::cout << "Lowest years: ";
+                    std::cin >> lo;
+                    std::cout << "Highest years: ";
+                    std::cin >> hi;
+                    indexes.yearsRange.range(lo, hi, spans);
+                    if (!displayFound(loans, spans, display))
+                        std::cout << "No loans with years in that range.\n";
+                }
+                else if (s == 8)
+                {
+                    std::cout << "Name starts with: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameTree.withPrefix(part, hits); // already in name order
+                            if (!displayFound(loans, hits, display))
+                                std::cout << "No loans with a name that starts with that.\n";
+                }
+                else if (s == 9)
+                {
+                    std::cout << "Name contains: ";
+                    std::string part;
+                    std::getline(std::cin >> std::ws, part);
+                    indexes.nameGrams.withSubstring(part, loans, [](const Loan &l) -> const std::string &
+                                                    { return l.name; },
+                                                    hits);
+                    Utilities::quickSortIndices(hits, loans, LoanBy::byName, ThreadPool::shared());
+                    if (!displayFound(loans, hits, display))
+                        std::cout << "No loans with a name that contains that.\n";
+                }
+                else if (s == 10)
+                {
+                    std::cout << "Filter: ";
+                    std::string text, error;
+                    std::getline(std::cin >> std::ws, text);
+                    std::vector<Query::Condition> conditions;
+                    std::vector<Query::Field> fields(3);
+                    fields[0].name = "principal";
+                    fields[0].doubleRange = &indexes.principalRange;
+                    fields[0].valueOf = [&](std::size_t idx)
+                    { return loans[idx].principal; };
+                    fields[1].name = "rate";
+                    fields[1].doubleBits = &indexes.rateBits;
+                    fields[2].name = "years";
+                    fields[2].intBits = &indexes.yearsBits;
+                    if (!Query::parse(text, conditions, error) || !Query::run(fields, conditions, hits, error))
+                        std::cout << error << "\n";
+                    else if (!displayFound(loans, hits, display))
+                        std::cout << "No loans match that filter.\n";
+                }
                 else
                     std::cout << "Invalid search option.\n";
             }
-            else if (ch == 5) // update → rebuild
+            else if (ch == 5) // update (incremental)
             {
                 std::cout << "Enter name to update: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ FIXED
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
                     auto &l = loans[idx];
+                    Loan before = l;
                     std::cout << "New principal (" << l.principal << "): ";
                     std::cin >> l.principal;
                     std::cout << "New rate (" << l.rate << "): ";
@@ -311,26 +948,27 @@ namespace Loans
                     std::cout << "New years (" << l.years << "): ";
                     std::cin >> l.years;
 
-                    rebuildAll(loans, viewOrder, nameIndex, principalIndex, rateIndex, yearsIndex);
+                    reindexAt(loans, viewOrder, viewBy, viewSorted, indexes, idx, before);
+                    journal.update(idx, loans[idx]);
                     recent.pushFront("Updated loan: " + key);
                     std::cout << "Updated.\n";
                 }
             }
-            else if (ch == 6) // delete → rebuild
+            else if (ch == 6) // delete (swap-and-pop)
             {
                 std::cout << "Enter name to delete: ";
                 std::string key;
                 std::getline(std::cin >> std::ws, key); // ⭐ FIXED
 
                 std::size_t idx;
-                if (!nameIndex.get(key, idx))
+                if (!indexes.nameIndex.get(key, idx))
                 {
                     std::cout << "Not found.\n";
                 }
                 else
                 {
-                    loans.erase(loans.begin() + idx);
-                    rebuildAll(loans, viewOrder, nameIndex, principalIndex, rateIndex, yearsIndex);
+                    journal.remove(idx);
+                    removeAt(loans, viewOrder, viewBy, viewSorted, indexes, idx);
                     recent.pushFront("Deleted loan: " + key);
                     std::cout << "Deleted.\n";
                 }
@@ -340,7 +978,10 @@ namespace Loans
                 std::vector<Loan> sample;
                 Storage::loadLoans(sample, "data/loans_sample.txt");
                 loans = sample;
-                rebuildAll(loans, viewOrder, nameIndex, principalIndex, rateIndex, yearsIndex);
+                journal.replaceAll(loans);
+                rebuildAll(loans, viewOrder, indexes);
+                viewBy = LoanBy::byName;
+                viewSorted = true;
                 recent.pushFront("Loaded sample loans");
                 std::cout << "Sample loans loaded.\n";
             }
@@ -348,24 +989,70 @@ namespace Loans
             {
                 loans.clear();
                 viewOrder.clear();
-                nameIndex = StringIntMap(101);
-                principalIndex.clear();
-                rateIndex.clear();
-                yearsIndex.clear();
+                viewSorted = true;
+                indexes.clear();
 
-                std::vector<Loan> empty;
-                Storage::saveLoans(empty, "data/loans.txt");
+                journal.replaceAll(loans);
 
                 recent.pushFront("Reset loan data");
                 std::cout << "All loan data reset.\n";
             }
+            else if (ch == 9) // summary (running totals)
+            {
+                std::cout << "Group by:\n"
+                          << "1) Years\n"
+                          << "2) Rate\n"
+                          << "Choice: ";
+                int g;
+                std::cin >> g;
+                displaySummary(loans, indexes.principalByYears, indexes.rateByYears, indexes.principalRange, g == 2);
+            }
+            else if (ch == 10) // page of the view, or top K
+            {
+                std::cout << "1) Page of the current view\n"
+                          << "2) Top K by principal\n"
+                          << "3) Top K by rate\n"
+                          << "4) Top K by years\n"
+                          << "Choice: ";
+                int v;
+                std::cin >> v;
+                if (v == 1)
+                {
+                    std::size_t offset = 0, limit = 0;
+                    std::cout << "First row (from 0): ";
+                    std::cin >> offset;
+                    std::cout << "Rows: ";
+                    std::cin >> limit;
+                    displayAll(loans, viewOrder, display, offset, limit);
+                }
+                else if (v >= 2 && v <= 4)
+                {
+                    std::size_t k = 0;
+                    std::cout << "K: ";
+                    std::cin >> k;
+                    // largest first; no full sort
+                    if (v == 2)
+                        Utilities::topKIndices(hits, loans, k, [](const Loan &a, const Loan &b)
+                                               { return LoanBy::byPrincipal(b, a); });
+                    else if (v == 3)
+                        Utilities::topKIndices(hits, loans, k, [](const Loan &a, const Loan &b)
+                                               { return LoanBy::byRate(b, a); });
+                    else if (v == 4)
+                        Utilities::topKIndices(hits, loans, k, [](const Loan &a, const Loan &b)
+                                               { return LoanBy::byYears(b, a); });
+                    displayAll(loans, hits, display);
+                }
+                else
+                    std::cout << "Invalid view option.\n";
+            }
             else
             {
                 break;
             }
         }
 
-        Storage::saveLoans(loans, "data/loans.txt");
+        // snapshot on exit, skipped when nothing changed
+        journal.checkpoint(loans);
     }
 
 } // namespace Loans
@@ -0,0 +1,290 @@
+#include "montecarlo.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MonteCarlo
+{
+    namespace
+    {
+        constexpr double TWO_PI = 6.283185307179586;
+
+        // Philox4x32-10 (Salmon et al., "Parallel random numbers: as
+        // easy as 1, 2, 3"): ten rounds of multiply-and-xor over a
+        // 128-bit counter under a 64-bit key
+        struct Philox
+        {
+            std::uint32_t x[4];
+
+            Philox(std::uint64_t seed, std::uint64_t p, std::uint32_t n)
+            {
+                std::uint32_t c0 = n, c1 = static_cast<std::uint32_t>(p), c2 = static_cast<std::uint32_t>(p >> 32), c3 = 0;
+                std::uint32_t k0 = static_cast<std::uint32_t>(seed), k1 = static_cast<std::uint32_t>(seed >> 32);
+                for (int round = 0; round < 10; ++round)
+                {
+                    std::uint64_t a = std::uint64_t(0xD2511F53u) * c0;
+                    std::uint64_t b = std::uint64_t(0xCD9E8D57u) * c2;
+                    std::uint32_t n0 = static_cast<std::uint32_t>(b >> 32) ^ c1 ^ k0;
+                    std::uint32_t n2 = static_cast<std::uint32_t>(a >> 32) ^ c3 ^ k1;
+                    c1 = static_cast<std::uint32_t>(b);
+                    c3 = static_cast<std::uint32_t>(a);
+                    c0 = n0;
+                    c2 = n2;
+                    k0 += 0x9E3779B9u;
+                    k1 += 0xBB67AE85u;
+                }
+                x[0] = c0;
+                x[1] = c1;
+                x[2] = c2;
+                x[3] = c3;
+            }
+        };
+
+        // 53 random bits as a double in (0, 1)
+        inline double unit(std::uint32_t hi, std::uint32_t lo)
+        {
+            std::uint64_t bits = ((std::uint64_t(hi) << 32) | lo) >> 11;
+            return (static_cast<double>(bits) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+
+        // draws t and t + 1 of a path share one Philox block (counter
+        // t / 2), whose two uniforms Box-Muller turns into two normals
+        inline void uniforms(std::uint64_t seed, std::uint64_t p, int t, double &u0, double &u1)
+        {
+            Philox block(seed, p, static_cast<std::uint32_t>(t / 2));
+            u0 = unit(block.x[0], block.x[1]);
+            u1 = unit(block.x[2], block.x[3]);
+        }
+
+        inline void boxMuller(double u0, double u1, double &z0, double &z1)
+        {
+            double radius = std::sqrt(-2 * std::log(u0));
+            double angle = TWO_PI * u1;
+            z0 = radius * std::cos(angle);
+            z1 = radius * std::sin(angle);
+        }
+
+        // per-month model constants
+        struct Step
+        {
+            bool cir;
+            double drift; // speed * dt
+            double level;
+            double shock; // vol * sqrt(dt)
+
+            explicit Step(const RateModel &m)
+                : cir(m.kind == RateModel::CIR), drift(m.speed / 12), level(m.level), shock(m.vol * std::sqrt(1.0 / 12)) {}
+
+            // the rate a month is priced at
+            double priced(double r) const { return cir && r < 0 ? 0 : r; }
+
+            double next(double r, double z) const
+            {
+                double x = priced(r);
+                double diffusion = cir ? shock * std::sqrt(x) : shock;
+                return r + drift * (level - x) + diffusion * z;
+            }
+        };
+
+        // paths [first, first + n), n <= BLOCK_PATHS, into out. Each
+        // stage is a loop over the block so the arithmetic vectorises;
+        // a path's running sums live in one slot of the arrays.
+        void runBlock(const Book &book, const RateModel &model, std::uint64_t seed,
+                      std::uint64_t first, std::size_t n, PathValue *out)
+        {
+            const Step step(model);
+            double r[BLOCK_PATHS], u[2][BLOCK_PATHS], z[2][BLOCK_PATHS];
+            double discount[BLOCK_PATHS], annuity[BLOCK_PATHS], moved[BLOCK_PATHS];
+            double loanValue[BLOCK_PATHS], maturity[BLOCK_PATHS], depositValue[BLOCK_PATHS];
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                r[k] = model.start;
+                discount[k] = 1;
+                annuity[k] = moved[k] = 0;
+                loanValue[k] = maturity[k] = depositValue[k] = 0;
+            }
+
+            for (int t = 1; t <= book.months; ++t)
+            {
+                // month t is priced at r from the end of month t - 1
+                for (std::size_t k = 0; k < n; ++k)
+                {
+                    double priced = step.priced(r[k]);
+                    discount[k] /= 1 + priced / 1200;
+                    annuity[k] += discount[k];
+                    moved[k] += priced - model.start;
+                }
+
+                // terms ending this month
+                double emi = book.loanEmi[t], amount = book.depositAmount[t], fixed = book.depositFixed[t];
+                if (emi != 0 || amount != 0)
+                    for (std::size_t k = 0; k < n; ++k)
+                    {
+                        double paid = fixed + amount * moved[k] / 1200;
+                        loanValue[k] += emi * annuity[k];
+                        maturity[k] += paid;
+                        depositValue[k] += paid * discount[k];
+                    }
+
+                if (t == book.months)
+                    break;
+                // the rate for month t + 1; normals come in pairs
+                int draw = t - 1;
+                if (draw % 2 == 0)
+                {
+                    for (std::size_t k = 0; k < n; ++k)
+                        uniforms(seed, first + k, draw, u[0][k], u[1][k]);
+                    for (std::size_t k = 0; k < n; ++k)
+                        boxMuller(u[0][k], u[1][k], z[0][k], z[1][k]);
+                }
+                const double *zt = z[draw % 2];
+                for (std::size_t k = 0; k < n; ++k)
+                    r[k] = step.next(r[k], zt[k]);
+            }
+
+            for (std::size_t k = 0; k < n; ++k)
+            {
+                out[k].loanValue = loanValue[k];
+                out[k].depositMaturity = maturity[k];
+                out[k].depositValue = depositValue[k];
+            }
+        }
+
+        // the calcEMI payment, principal / months at 0 %
+        void payments(const LoanTable &loans, std::vector<double> &emi)
+        {
+            Loans::calcEMI(loans, emi);
+            for (std::size_t i = 0; i < loans.size(); ++i)
+                if (loans.rate[i] == 0 && loans.years[i] > 0)
+                    emi[i] = loans.principal[i] / (loans.years[i] * 12);
+        }
+    }
+
+    Book Book::from(const LoanTable &loans, const DepositTable &deposits)
+    {
+        Book book;
+        for (int years : loans.years)
+            book.months = std::max(book.months, years * 12);
+        for (int months : deposits.months)
+            book.months = std::max(book.months, months);
+
+        book.loanEmi.assign(book.months + 1, 0);
+        book.depositAmount.assign(book.months + 1, 0);
+        book.depositFixed.assign(book.months + 1, 0);
+
+        std::vector<double> values;
+        payments(loans, values);
+        for (std::size_t i = 0; i < loans.size(); ++i)
+            if (loans.years[i] > 0)
+                book.loanEmi[loans.years[i] * 12] += values[i];
+
+        Deposits::calcMaturity(deposits, values);
+        for (std::size_t i = 0; i < deposits.size(); ++i)
+            if (deposits.months[i] > 0)
+            {
+                book.depositAmount[deposits.months[i]] += deposits.amount[i];
+                book.depositFixed[deposits.months[i]] += values[i];
+            }
+        return book;
+    }
+
+    void path(const RateModel &model, std::uint64_t seed, std::uint64_t p, int months, double *rate)
+    {
+        const Step step(model);
+        double u[2], z[2] = {0, 0};
+        rate[0] = model.start;
+        for (int t = 1; t <= months; ++t)
+        {
+            int draw = t - 1;
+            if (draw % 2 == 0)
+            {
+                uniforms(seed, p, draw, u[0], u[1]);
+                boxMuller(u[0], u[1], z[0], z[1]);
+            }
+            rate[t] = step.next(rate[t - 1], z[draw % 2]);
+        }
+    }
+
+    void simulate(const Book &book, const RateModel &model, std::uint64_t seed,
+                  std::uint64_t first, std::size_t paths, PathValue *out, ThreadPool &pool)
+    {
+        TaskGroup group(pool);
+        for (std::size_t begin = 0; begin < paths; begin += PATHS_PER_TASK)
+            group.run([&, begin]()
+                      {
+                std::size_t end = std::min(paths, begin + PATHS_PER_TASK);
+                for (std::size_t b = begin; b < end; b += BLOCK_PATHS)
+                    runBlock(book, model, seed, first + b, std::min(BLOCK_PATHS, end - b), out + b); });
+        group.wait();
+    }
+
+    PathValue valuePath(const LoanTable &loans, const DepositTable &deposits,
+                        const RateModel &model, const double *rate)
+    {
+        const Step step(model);
+        int months = 0;
+        for (int years : loans.years)
+            months = std::max(months, years * 12);
+        for (int m : deposits.months)
+            months = std::max(months, m);
+
+        // discount[t] and the move away from start over months 1..t
+        std::vector<double> discount(months + 1, 1), moved(months + 1, 0);
+        for (int t = 1; t <= months; ++t)
+        {
+            double priced = step.priced(rate[t - 1]);
+            discount[t] = discount[t - 1] / (1 + priced / 1200);
+            moved[t] = moved[t - 1] + priced - model.start;
+        }
+
+        PathValue v;
+        std::vector<double> emi;
+        payments(loans, emi);
+        for (std::size_t i = 0; i < loans.size(); ++i)
+            for (int t = 1; t <= loans.years[i] * 12; ++t)
+                v.loanValue += emi[i] * discount[t];
+
+        for (std::size_t i = 0; i < deposits.size(); ++i)
+        {
+            int m = deposits.months[i];
+            if (m <= 0)
+                continue;
+            double paid = Deposits::calcMaturity(deposits.row(i)) + deposits.amount[i] * moved[m] / 1200;
+            v.depositMaturity += paid;
+            v.depositValue += paid * discount[m];
+        }
+        return v;
+    }
+
+    PathStats stats(const PathValue *values, std::size_t n, double PathValue::*field)
+    {
+        PathStats s;
+        if (n == 0)
+            return s;
+        std::vector<double> x(n);
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            x[i] = values[i].*field;
+            sum += x[i];
+        }
+        s.mean = sum / n;
+        double squares = 0;
+        for (double v : x)
+            squares += (v - s.mean) * (v - s.mean);
+        s.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+
+        // nearest-rank percentiles
+        auto at = [&](double q)
+        {
+            std::size_t k = static_cast<std::size_t>(q * (n - 1) + 0.5);
+            std::nth_element(x.begin(), x.begin() + k, x.end());
+            return x[k];
+        };
+        s.p5 = at(0.05);
+        s.p50 = at(0.50);
+        s.p95 = at(0.95);
+        return s;
+    }
+}
@@ -0,0 +1,297 @@
+#include "query.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+namespace Query
+{
+    namespace
+    {
+        // the closed interval [lo, hi] a condition covers; false when empty
+        bool bounds(const Condition &c, double &lo, double &hi)
+        {
+            const double inf = std::numeric_limits<double>::infinity();
+            lo = -inf;
+            hi = inf;
+            switch (c.op)
+            {
+            case Op::Less:
+                hi = std::nextafter(c.value, -inf);
+                break;
+            case Op::LessEq:
+                hi = c.value;
+                break;
+            case Op::Equal:
+                lo = hi = c.value;
+                break;
+            case Op::GreaterEq:
+                lo = c.value;
+                break;
+            case Op::Greater:
+                lo = std::nextafter(c.value, inf);
+                break;
+            }
+            return lo <= hi;
+        }
+
+        // [lo, hi] over ints, clamped to their range; false when empty
+        bool intBounds(double lo, double hi, int &ilo, int &ihi)
+        {
+            lo = std::ceil(lo);
+            hi = std::floor(hi);
+            const double min = std::numeric_limits<int>::min(), max = std::numeric_limits<int>::max();
+            if (lo > max || hi < min || lo > hi)
+                return false;
+            ilo = static_cast<int>(std::max(lo, min));
+            ihi = static_cast<int>(std::min(hi, max));
+            return true;
+        }
+
+        // every condition on one field, folded into one interval
+        struct Term
+        {
+            const Field *field;
+            double lo, hi;
+        };
+
+        bool readOp(const std::string &s, Op &op)
+        {
+            if (s == "<")
+                op = Op::Less;
+            else if (s == "<=")
+                op = Op::LessEq;
+            else if (s == "=" || s == "==")
+                op = Op::Equal;
+            else if (s == ">=")
+                op = Op::GreaterEq;
+            else if (s == ">")
+                op = Op::Greater;
+            else
+                return false;
+            return true;
+        }
+    }
+
+    bool parse(const std::string &text, std::vector<Condition> &out, std::string &error)
+    {
+        out.clear();
+
+        // split "rate>=7.5" into "rate >= 7.5" so tokens are whitespace-separated
+        std::string spaced;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            char ch = text[i];
+            bool opChar = ch == '<' || ch == '>' || ch == '=';
+            bool prevOp = i > 0 && (text[i - 1] == '<' || text[i - 1] == '>' || text[i - 1] == '=');
+            if (opChar != prevOp && i > 0)
+                spaced += ' ';
+            spaced += ch;
+        }
+
+        std::istringstream in(spaced);
+        std::string field, opText, valueText, joiner;
+        bool dangling = false; // an AND with nothing after it
+        while (in >> field)
+        {
+            dangling = false;
+            Condition c;
+            c.field = field;
+            if (!(in >> opText) || !readOp(opText, c.op))
+            {
+                error = "expected < <= = >= > after " + field;
+                return false;
+            }
+            if (!(in >> valueText))
+            {
+                error = "expected a number after " + field + " " + opText;
+                return false;
+            }
+            char *end = nullptr;
+            c.value = std::strtod(valueText.c_str(), &end);
+            if (*end != '\0' || c.value - c.value != 0)
+            {
+                error = "not a number: " + valueText;
+                return false;
+            }
+            out.push_back(c);
+
+            if (!(in >> joiner))
+                break;
+            std::transform(joiner.begin(), joiner.end(), joiner.begin(), [](unsigned char ch)
+                           { return static_cast<char>(std::toupper(ch)); });
+            if (joiner != "AND")
+            {
+                error = "expected AND, got " + joiner;
+                return false;
+            }
+            dangling = true;
+        }
+        if (dangling)
+        {
+            error = "condition missing after AND";
+            return false;
+        }
+        if (out.empty())
+        {
+            error = "no conditions";
+            return false;
+        }
+        return true;
+    }
+
+    bool run(const std::vector<Field> &fields, const std::vector<Condition> &conditions,
+             std::vector<std::size_t> &rows, std::string &error)
+    {
+        rows.clear();
+        std::vector<Term> terms;
+        bool none = false; // some interval is empty: nothing matches
+        for (const Condition &c : conditions)
+        {
+            auto f = std::find_if(fields.begin(), fields.end(), [&](const Field &f)
+                                  { return f.name == c.field; });
+            if (f == fields.end())
+            {
+                error = "unknown field: " + c.field;
+                return false;
+            }
+            double lo = 0, hi = 0;
+            none = none || !bounds(c, lo, hi);
+            auto t = std::find_if(terms.begin(), terms.end(), [&](const Term &t)
+                                  { return t.field == &*f; });
+            if (t == terms.end())
+                terms.push_back(Term{&*f, lo, hi});
+            else
+            {
+                t->lo = std::max(t->lo, lo);
+                t->hi = std::min(t->hi, hi);
+                none = none || t->lo > t->hi;
+            }
+        }
+        if (none)
+            return true;
+
+        // bitmap terms, ANDed smallest first
+        std::vector<RoaringBitmap> sets;
+        std::vector<const Term *> ranged;
+        for (const Term &t : terms)
+        {
+            if (t.field->doubleRange)
+            {
+                ranged.push_back(&t);
+                continue;
+            }
+            sets.emplace_back();
+            int lo, hi;
+            if (t.field->doubleBits)
+                t.field->doubleBits->select(t.lo, t.hi, sets.back());
+            else if (intBounds(t.lo, t.hi, lo, hi))
+                t.field->intBits->select(lo, hi, sets.back());
+            if (sets.back().empty())
+                return true;
+        }
+        std::vector<std::size_t> cards(sets.size()), order(sets.size());
+        for (std::size_t i = 0; i < sets.size(); ++i)
+        {
+            cards[i] = sets[i].cardinality();
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                  { return cards[a] < cards[b]; });
+
+        bool haveSet = !sets.empty();
+        RoaringBitmap result;
+        if (haveSet)
+        {
+            result = std::move(sets[order[0]]);
+            for (std::size_t k = 1; k < order.size() && !result.empty(); ++k)
+                result.andWith(sets[order[k]]);
+        }
+
+        // range terms, narrowest first
+        std::vector<std::size_t> hitCounts(ranged.size());
+        for (std::size_t i = 0; i < ranged.size(); ++i)
+        {
+            hitCounts[i] = ranged[i]->field->doubleRange->count(ranged[i]->lo, ranged[i]->hi);
+            if (hitCounts[i] == 0)
+                return true;
+        }
+        order.resize(ranged.size());
+        for (std::size_t i = 0; i < ranged.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                  { return hitCounts[a] < hitCounts[b]; });
+
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<const Term *> filters;
+        std::vector<IndexSpan> spans;
+        std::vector<std::size_t> picked;
+        for (std::size_t i : order)
+        {
+            const Term &t = *ranged[i];
+            const RangeIndex<double> &index = *t.field->doubleRange;
+            std::size_t hits = hitCounts[i], outside = index.size() - hits;
+
+            // cheapest of: check what's left at the end, drop the rows
+            // outside the range, or keep the rows inside it
+            if (haveSet && result.cardinality() <= std::min(hits, outside))
+            {
+                filters.push_back(&t);
+                continue;
+            }
+            if (haveSet && outside < hits)
+            {
+                if (t.lo > -inf)
+                {
+                    index.range(-inf, std::nextafter(t.lo, -inf), spans);
+                    for (const IndexSpan &span : spans)
+                        for (std::size_t row : span)
+                            result.remove(static_cast<std::uint32_t>(row));
+                }
+                if (t.hi < inf)
+                {
+                    index.range(std::nextafter(t.hi, inf), inf, spans);
+                    for (const IndexSpan &span : spans)
+                        for (std::size_t row : span)
+                            result.remove(static_cast<std::uint32_t>(row));
+                }
+                continue;
+            }
+
+            // spans come in key order; sorted rows make every add an append
+            picked.clear();
+            index.range(t.lo, t.hi, spans);
+            for (const IndexSpan &span : spans)
+                for (std::size_t row : span)
+                    if (!haveSet || result.contains(static_cast<std::uint32_t>(row)))
+                        picked.push_back(row);
+            std::sort(picked.begin(), picked.end());
+            result.clear();
+            for (std::size_t row : picked)
+                result.add(static_cast<std::uint32_t>(row));
+            haveSet = true;
+        }
+
+        result.rows(rows);
+        if (!filters.empty())
+        {
+            std::size_t kept = 0;
+            for (std::size_t row : rows)
+            {
+                bool ok = true;
+                for (std::size_t k = 0; ok && k < filters.size(); ++k)
+                {
+                    double v = filters[k]->field->valueOf(row);
+                    ok = filters[k]->lo <= v && v <= filters[k]->hi;
+                }
+                if (ok)
+                    rows[kept++] = row;
+            }
+            rows.resize(kept);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,127 @@
+#include "scenarios.hpp"
+#include "rate_kernels.hpp"
+#include "thread_pool.hpp"
+
+namespace Scenarios
+{
+    namespace
+    {
+        void addTotals(ScenarioTotals &into, const ScenarioTotals &from)
+        {
+            into.loans += from.loans;
+            into.emi += from.emi;
+            into.loanInterest += from.loanInterest;
+            into.deposits += from.deposits;
+            into.maturity += from.maturity;
+            into.depositInterest += from.depositInterest;
+        }
+
+        // tile(first, last, totals) for every tile of [0, rows); each task
+        // runs TILES_PER_TASK tiles into its own row of per-scenario
+        // totals, and the rows are added into out in book order
+        template <typename Tile>
+        void runTiles(std::size_t rows, std::size_t scenarios, ThreadPool &pool,
+                      std::vector<ScenarioTotals> &out, Tile tile)
+        {
+            const std::size_t taskRows = TILE_ROWS * TILES_PER_TASK;
+            std::size_t tasks = (rows + taskRows - 1) / taskRows;
+            std::vector<ScenarioTotals> partial(tasks * scenarios);
+
+            TaskGroup group(pool);
+            for (std::size_t t = 0; t < tasks; ++t)
+                group.run([&, t]()
+                          {
+                std::size_t end = (t + 1) * taskRows < rows ? (t + 1) * taskRows : rows;
+                for (std::size_t first = t * taskRows; first < end; first += TILE_ROWS)
+                    tile(first, first + TILE_ROWS < end ? first + TILE_ROWS : end, &partial[t * scenarios]); });
+            group.wait();
+
+            for (std::size_t t = 0; t < tasks; ++t)
+                for (std::size_t s = 0; s < scenarios; ++s)
+                    addTotals(out[s], partial[t * scenarios + s]);
+        }
+    }
+
+    std::vector<Scenario> grid(const std::vector<double> &rateShifts, const std::vector<int> &termShifts)
+    {
+        std::vector<Scenario> out;
+        out.reserve(rateShifts.size() * termShifts.size());
+        for (int term : termShifts)
+            for (double rate : rateShifts)
+                out.push_back(Scenario{rate, term});
+        return out;
+    }
+
+    std::vector<ScenarioTotals> run(const LoanTable &loans, const DepositTable &deposits,
+                                    const std::vector<Scenario> &scenarios, ThreadPool &pool)
+    {
+        std::vector<ScenarioTotals> totals(scenarios.size());
+
+        // loans: EMI over (shifted rate, shifted months), the calcEMI formula
+        runTiles(loans.size(), scenarios.size(), pool, totals,
+                 [&](std::size_t first, std::size_t last, ScenarioTotals *out)
+                 {
+                     double rate[TILE_ROWS], growth[TILE_ROWS];
+                     int months[TILE_ROWS];
+                     std::size_t n = last - first;
+                     const double *principal = loans.principal.data() + first;
+                     for (std::size_t s = 0; s < scenarios.size(); ++s)
+                     {
+                         for (std::size_t k = 0; k < n; ++k)
+                         {
+                             rate[k] = loans.rate[first + k] + scenarios[s].rateShift;
+                             months[k] = loans.years[first + k] * 12 + scenarios[s].termShift;
+                         }
+                         RateKernels::growth(rate, 12 * 100, months, 1, n, growth);
+
+                         std::size_t count = 0;
+                         double emiSum = 0, interestSum = 0;
+                         for (std::size_t k = 0; k < n; ++k)
+                         {
+                             if (months[k] <= 0)
+                                 continue;
+                             double monthlyRate = rate[k] / (12 * 100);
+                             double emi = principal[k] / months[k];
+                             if (monthlyRate != 0 && growth[k] != 1)
+                                 emi = (principal[k] * monthlyRate * growth[k]) / (growth[k] - 1);
+                             ++count;
+                             emiSum += emi;
+                             interestSum += emi * months[k] - principal[k];
+                         }
+                         out[s].loans += count;
+                         out[s].emi += emiSum;
+                         out[s].loanInterest += interestSum;
+                     }
+                 });
+
+        // deposits: simple interest to maturity, the calcMaturity formula
+        runTiles(deposits.size(), scenarios.size(), pool, totals,
+                 [&](std::size_t first, std::size_t last, ScenarioTotals *out)
+                 {
+                     const double *amount = deposits.amount.data() + first;
+                     const double *rate = deposits.rate.data() + first;
+                     const int *months = deposits.months.data() + first;
+                     std::size_t n = last - first;
+                     for (std::size_t s = 0; s < scenarios.size(); ++s)
+                     {
+                         std::size_t count = 0;
+                         double maturitySum = 0, interestSum = 0;
+                         for (std::size_t k = 0; k < n; ++k)
+                         {
+                             int m = months[k] + scenarios[s].termShift;
+                             if (m <= 0)
+                                 continue;
+                             double interest = amount[k] * (rate[k] + scenarios[s].rateShift) * (m / 12.0) / 100.0;
+                             ++count;
+                             maturitySum += amount[k] + interest;
+                             interestSum += interest;
+                         }
+                         out[s].deposits += count;
+                         out[s].maturity += maturitySum;
+                         out[s].depositInterest += interestSum;
+                     }
+                 });
+
+        return totals;
+    }
+}
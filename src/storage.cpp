@@ -1,93 +1,1573 @@
 #include "storage.hpp"
 #include <fstream>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <charconv>
+#include <string_view>
+#include <cerrno>
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Storage
 {
-    bool saveDeposits(const std::vector<Deposit> &deps, const std::string &path)
+    namespace
     {
-        std::ofstream out(path);
-        if (!out)
+        const char COLUMN_MAGIC[8] = {'F', 'I', 'N', 'C', 'O', 'L', 0, 0};
+
+        // which record / table fields sit in the shared amount, rate
+        // and term columns (tables use the record's field names)
+        struct DepositColumns
+        {
+            static constexpr BookKind kind = BookKind::Deposits;
+            template <typename T>
+            static auto &amount(T &x) { return x.amount; }
+            template <typename T>
+            static auto &rate(T &x) { return x.rate; }
+            template <typename T>
+            static auto &term(T &x) { return x.months; }
+        };
+
+        struct LoanColumns
+        {
+            static constexpr BookKind kind = BookKind::Loans;
+            template <typename T>
+            static auto &amount(T &x) { return x.principal; }
+            template <typename T>
+            static auto &rate(T &x) { return x.rate; }
+            template <typename T>
+            static auto &term(T &x) { return x.years; }
+        };
+
+        struct CreditColumns
+        {
+            static constexpr BookKind kind = BookKind::Credits;
+            template <typename T>
+            static auto &amount(T &x) { return x.amount; }
+            template <typename T>
+            static auto &rate(T &x) { return x.interest; }
+            template <typename T>
+            static auto &term(T &x) { return x.months; }
+        };
+
+        std::uint64_t align8(std::uint64_t pos) { return (pos + 7) & ~std::uint64_t(7); }
+
+        // ----- durable file writes -----
+        bool writeAll(int fd, const char *p, std::size_t n)
+        {
+            while (n > 0)
+            {
+                ssize_t w = ::write(fd, p, n);
+                if (w < 0 && errno == EINTR)
+                    continue;
+                if (w <= 0)
+                    return false;
+                p += w;
+                n -= static_cast<std::size_t>(w);
+            }
+            return true;
+        }
+
+        bool syncData(int fd)
+        {
+#if defined(__APPLE__)
+            return fsync(fd) == 0;
+#else
+            return fdatasync(fd) == 0;
+#endif
+        }
+
+        std::string dirOf(const std::string &path)
+        {
+            std::size_t slash = path.rfind('/');
+            if (slash == std::string::npos)
+                return ".";
+            return slash == 0 ? "/" : path.substr(0, slash);
+        }
+
+        // makes a create / rename / unlink in the directory durable
+        void syncDir(const std::string &path)
+        {
+            int fd = ::open(dirOf(path).c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            fsync(fd);
+            ::close(fd);
+        }
+
+        constexpr std::size_t WRITE_CHUNK = 1 << 20;
+
+        // buffered writes to an fd; the first failure sticks
+        class FdWriter
+        {
+        public:
+            explicit FdWriter(int fd) : fd_(fd) { buf.reserve(WRITE_CHUNK); }
+
+            std::string buf; // format into this, then call spill()
+
+            void put(const void *p, std::size_t n)
+            {
+                if (n >= WRITE_CHUNK)
+                {
+                    flush();
+                    ok_ = ok_ && writeAll(fd_, static_cast<const char *>(p), n);
+                    return;
+                }
+                buf.append(static_cast<const char *>(p), n);
+                spill();
+            }
+            void spill()
+            {
+                if (buf.size() >= WRITE_CHUNK)
+                    flush();
+            }
+            bool flush()
+            {
+                ok_ = ok_ && writeAll(fd_, buf.data(), buf.size());
+                buf.clear();
+                return ok_;
+            }
+
+        private:
+            int fd_;
+            bool ok_ = true;
+        };
+
+        std::string tempPath(const std::string &path) { return path + ".tmp"; }
+
+        // a fresh <path>.tmp next to path, or -1
+        int createTemp(const std::string &path)
+        {
+            std::string tmp = tempPath(path);
+            ::unlink(tmp.c_str());
+            return ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        }
+
+        // Makes the finished temp durable and renames it over path, then
+        // syncs the directory so the rename sticks; closes fd. If anything
+        // failed (written == false included) the temp is removed and path
+        // is left as it was.
+        bool installTemp(int fd, bool written, const std::string &path)
+        {
+            std::string tmp = tempPath(path);
+            bool ok = written && fsync(fd) == 0;
+            ok = ::close(fd) == 0 && ok;
+            if (ok && std::rename(tmp.c_str(), path.c_str()) == 0)
+            {
+                syncDir(path);
+                return true;
+            }
+            ::unlink(tmp.c_str());
             return false;
-        for (const auto &d : deps)
+        }
+
+        // write(fd) -> bool fills the temp; a crash leaves the old file or the new one
+        template <typename Write>
+        bool saveAtomically(const std::string &path, Write write)
         {
-            out << d.name << " "
-                << d.amount << " "
-                << d.rate << " "
-                << d.months << "\n";
+            int fd = createTemp(path);
+            if (fd < 0)
+                return false;
+            return installTemp(fd, write(fd), path);
+        }
+
+        template <typename Cols, typename Table>
+        bool writeColumnFile(const Table &t, int fd)
+        {
+            static_assert(sizeof(int) == sizeof(std::int32_t), "term column is stored as int32");
+            std::uint64_t rows = t.size();
+
+            ColumnFileHeader h{};
+            std::memcpy(h.magic, COLUMN_MAGIC, sizeof h.magic);
+            h.version = COLUMN_FILE_VERSION;
+            h.byteOrder = COLUMN_FILE_BYTE_ORDER;
+            h.kind = static_cast<std::uint32_t>(Cols::kind);
+            h.rows = rows;
+            h.nameOffsets = sizeof(ColumnFileHeader);
+            h.amount = h.nameOffsets + (rows + 1) * sizeof(std::uint64_t);
+            h.rate = h.amount + rows * sizeof(double);
+            h.term = h.rate + rows * sizeof(double);
+            h.heap = align8(h.term + rows * sizeof(std::int32_t));
+
+            std::vector<std::uint64_t> offsets(rows + 1);
+            offsets[0] = 0;
+            for (std::uint64_t i = 0; i < rows; ++i)
+                offsets[i + 1] = offsets[i] + t.name[i].size();
+            h.heapSize = offsets[rows];
+            h.fileSize = h.heap + h.heapSize;
+
+            FdWriter out(fd);
+            const char pad[8] = {};
+            out.put(&h, sizeof h);
+            out.put(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+            out.put(Cols::amount(t).data(), rows * sizeof(double));
+            out.put(Cols::rate(t).data(), rows * sizeof(double));
+            out.put(Cols::term(t).data(), rows * sizeof(std::int32_t));
+            out.put(pad, h.heap - (h.term + rows * sizeof(std::int32_t)));
+            for (const auto &name : t.name)
+                out.put(name.data(), name.size());
+            return out.flush();
+        }
+
+        // numeric columns are block copies; only the names are built one by one
+        template <typename Cols, typename Table>
+        bool readColumnTable(Table &t, const std::string &path)
+        {
+            MappedColumns m;
+            if (!m.open(path, Cols::kind))
+                return false;
+            std::size_t n = m.rows();
+            t.clear();
+            t.name.reserve(n);
+            for (std::size_t i = 0; i < n; ++i)
+                t.name.emplace_back(m.name(i));
+            Cols::amount(t).assign(m.amount(), m.amount() + n);
+            Cols::rate(t).assign(m.rate(), m.rate() + n);
+            Cols::term(t).assign(m.term(), m.term() + n);
+            return true;
+        }
+
+        template <typename Cols, typename Record>
+        bool readColumnRecords(std::vector<Record> &out, const std::string &path)
+        {
+            MappedColumns m;
+            if (!m.open(path, Cols::kind))
+                return false;
+            std::size_t n = m.rows();
+            out.clear();
+            out.resize(n);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                Record &r = out[i];
+                r.name.assign(m.name(i));
+                Cols::amount(r) = m.amount()[i];
+                Cols::rate(r) = m.rate()[i];
+                Cols::term(r) = m.term()[i];
+            }
+            return true;
+        }
+
+        // ----- text parsing -----
+        // whole file in memory: mmap'd when it is a regular file, read in
+        // 64 KB blocks otherwise (pipes, special files)
+        class FileBytes
+        {
+        public:
+            FileBytes() = default;
+            ~FileBytes()
+            {
+                if (map_)
+                    munmap(map_, size_);
+            }
+            FileBytes(const FileBytes &) = delete;
+            FileBytes &operator=(const FileBytes &) = delete;
+
+            bool open(const std::string &path)
+            {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return false;
+                struct stat st;
+                if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+                {
+                    size_ = static_cast<std::size_t>(st.st_size);
+                    if (size_ == 0)
+                    {
+                        ::close(fd);
+                        return true;
+                    }
+#ifdef MAP_POPULATE
+                    int flags = MAP_PRIVATE | MAP_POPULATE; // fault it all in up front
+#else
+                    int flags = MAP_PRIVATE;
+#endif
+                    void *map = mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+                    if (map != MAP_FAILED)
+                    {
+                        ::close(fd);
+                        madvise(map, size_, MADV_SEQUENTIAL);
+                        map_ = map;
+                        data_ = static_cast<const char *>(map);
+                        return true;
+                    }
+                }
+
+                char block[1 << 16];
+                ssize_t got;
+                while ((got = ::read(fd, block, sizeof block)) > 0)
+                    buffer_.append(block, static_cast<std::size_t>(got));
+                ::close(fd);
+                data_ = buffer_.data();
+                size_ = buffer_.size();
+                return got == 0;
+            }
+
+            const char *data() const { return data_; }
+            std::size_t size() const { return size_; }
+
+        private:
+            void *map_ = nullptr;
+            const char *data_ = nullptr;
+            std::size_t size_ = 0;
+            std::string buffer_;
+        };
+
+        bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        // whole token or nothing; a leading '+' is allowed like operator>> did
+        bool parseNumber(std::string_view tok, int &out)
+        {
+            if (!tok.empty() && tok.front() == '+')
+                tok.remove_prefix(1);
+            auto r = std::from_chars(tok.data(), tok.data() + tok.size(), out);
+            return r.ec == std::errc() && r.ptr == tok.data() + tok.size();
+        }
+
+        // Clinger's fast path: "123.45" with a mantissa under 2^53 and at
+        // most 22 decimals is mantissa / 10^decimals, both exact, so the one
+        // rounding of the division gives the correctly rounded result,
+        // the same double from_chars / strtod produce. Covers everything
+        // saveX writes; other spellings go to the full parser.
+        // Reads from p up to the first character that can't continue the
+        // number; nullptr if what it read doesn't qualify.
+        const char *scanSimpleDecimal(const char *p, const char *end, double &out)
+        {
+            static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            bool negative = p != end && *p == '-';
+            if (negative)
+                ++p;
+            std::uint64_t mantissa = 0;
+            int digits = 0, decimals = 0;
+            bool dot = false;
+            for (; p != end; ++p)
+            {
+                if (*p >= '0' && *p <= '9')
+                {
+                    if (++digits > 15)
+                        return nullptr;
+                    mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+                    decimals += dot;
+                }
+                else if (*p == '.' && !dot)
+                    dot = true;
+                else
+                    break;
+            }
+            if (digits == 0)
+                return nullptr;
+            double v = static_cast<double>(mantissa) / POW10[decimals];
+            out = negative ? -v : v;
+            return p;
+        }
+
+        // the usual line, "name amount rate term" with a one-word name,
+        // single spaces and plain numbers, parsed in one forward pass.
+        // Returns the start of the next line, or nullptr when the line
+        // needs the general path.
+        const char *parseLineFast(const char *p, const char *end, std::string_view &name,
+                                  double &amount, double &rate, int &term)
+        {
+            const char *b = p;
+            while (p != end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                ++p;
+            if (p == b || p == end || *p != ' ')
+                return nullptr;
+            name = std::string_view(b, p - b);
+
+            p = scanSimpleDecimal(p + 1, end, amount);
+            if (!p || p == end || *p != ' ')
+                return nullptr;
+            p = scanSimpleDecimal(p + 1, end, rate);
+            if (!p || p == end || *p != ' ')
+                return nullptr;
+
+            const char *t = ++p;
+            int v = 0;
+            while (p != end && *p >= '0' && *p <= '9' && p - t < 9)
+                v = v * 10 + (*p++ - '0');
+            if (p == t)
+                return nullptr;
+            if (p != end && *p == '\r')
+                ++p;
+            if (p != end && *p != '\n')
+                return nullptr;
+            term = v;
+            return p == end ? end : p + 1;
+        }
+
+        bool parseNumber(std::string_view tok, double &out)
+        {
+            if (!tok.empty() && tok.front() == '+')
+                tok.remove_prefix(1);
+            const char *tokEnd = tok.data() + tok.size();
+            if (scanSimpleDecimal(tok.data(), tokEnd, out) == tokEnd)
+                return true;
+#if defined(__cpp_lib_to_chars)
+            auto r = std::from_chars(tok.data(), tok.data() + tok.size(), out);
+            return r.ec == std::errc() && r.ptr == tok.data() + tok.size();
+#else
+            // standard library without floating-point from_chars
+            char buf[64];
+            if (tok.empty() || tok.size() >= sizeof buf)
+                return false;
+            std::memcpy(buf, tok.data(), tok.size());
+            buf[tok.size()] = '\0';
+            char *end;
+            out = std::strtod(buf, &end);
+            return end == buf + tok.size();
+#endif
+        }
+
+        constexpr int MAX_REPORTED_BAD_LINES = 10;
+
+        // one chunk's line count and its first bad lines
+        struct ChunkReport
+        {
+            struct BadLine
+            {
+                std::size_t line; // within the chunk, from 1
+                const char *what;
+                std::string tok;
+            };
+            std::size_t lines = 0;
+            std::size_t badLines = 0;
+            std::vector<BadLine> bad; // at most MAX_REPORTED_BAD_LINES
+        };
+
+        // Parses the "name amount rate term" lines of [p, end), which starts
+        // at a line start. The last three fields are the numbers and
+        // everything before them is the name, so names may contain spaces.
+        // Blank lines are skipped; a malformed line is noted in report and
+        // skipped. emit(name, amount, rate, term) runs once per good line.
+        template <typename Emit>
+        void parseLines(const char *p, const char *end, ChunkReport &report, Emit emit)
+        {
+            std::size_t lineNo = 0;
+            auto bad = [&](const char *what, std::string_view tok)
+            {
+                if (++report.badLines <= static_cast<std::size_t>(MAX_REPORTED_BAD_LINES))
+                    report.bad.push_back({lineNo, what, std::string(tok)});
+            };
+
+            while (p < end)
+            {
+                ++lineNo;
+                std::string_view name;
+                double amount, rate;
+                int term;
+                if (const char *next = parseLineFast(p, end, name, amount, rate, term))
+                {
+                    emit(name, amount, rate, term);
+                    p = next;
+                    continue;
+                }
+
+                const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+                const char *lineEnd = nl ? nl : end;
+                const char *b = p;
+                const char *e = lineEnd;
+                p = nl ? nl + 1 : end;
+
+                while (b < e && isBlank(*b))
+                    ++b;
+                while (e > b && isBlank(e[-1]))
+                    --e;
+                if (b == e)
+                    continue;
+
+                // the three numeric fields, right to left
+                std::string_view fields[3];
+                bool complete = true;
+                for (int f = 2; f >= 0; --f)
+                {
+                    const char *tokEnd = e;
+                    while (e > b && !isBlank(e[-1]))
+                        --e;
+                    fields[f] = std::string_view(e, tokEnd - e);
+                    while (e > b && isBlank(e[-1]))
+                        --e;
+                    if (fields[f].empty() || e == b) // name must be left over
+                    {
+                        complete = false;
+                        break;
+                    }
+                }
+                if (!complete)
+                {
+                    bad("expected: name amount rate term", {});
+                    continue;
+                }
+
+                if (!parseNumber(fields[0], amount))
+                    bad("bad amount", fields[0]);
+                else if (!parseNumber(fields[1], rate))
+                    bad("bad rate", fields[1]);
+                else if (!parseNumber(fields[2], term))
+                    bad("bad term", fields[2]);
+                else
+                    emit(std::string_view(b, e - b), amount, rate, term);
+            }
+            report.lines = lineNo;
+        }
+
+        // Prints a chunk's bad lines, numbered from lineBase, while fewer than
+        // MAX_REPORTED_BAD_LINES have been printed. badLines is the running
+        // count of bad lines before this chunk.
+        void reportBadLines(const std::string &path, const ChunkReport &report, std::size_t lineBase,
+                            std::size_t &badLines)
+        {
+            for (const auto &b : report.bad)
+            {
+                if (badLines + (&b - report.bad.data()) >= static_cast<std::size_t>(MAX_REPORTED_BAD_LINES))
+                    break;
+                std::cerr << path << ":" << lineBase + b.line << ": " << b.what;
+                if (!b.tok.empty())
+                    std::cerr << " '" << b.tok << "'";
+                std::cerr << "\n";
+            }
+            badLines += report.badLines;
+        }
+
+        void reportSkippedLines(const std::string &path, std::size_t badLines)
+        {
+            if (badLines > static_cast<std::size_t>(MAX_REPORTED_BAD_LINES))
+                std::cerr << path << ": " << badLines - MAX_REPORTED_BAD_LINES << " more bad lines skipped\n";
+        }
+
+        // fn(c) for every chunk c, as pool tasks when there is more than one
+        template <typename F>
+        void forEachChunk(ThreadPool &pool, std::size_t chunks, F fn)
+        {
+            if (chunks == 1)
+            {
+                fn(0);
+                return;
+            }
+            TaskGroup group(pool);
+            for (std::size_t c = 0; c < chunks; ++c)
+                group.run([&fn, c]()
+                          { fn(c); });
+            group.wait();
+        }
+
+        // Reads a text book into parts, one per chunk in file order. Part
+        // holds one chunk's rows: reserve(n), add(name, amount, rate, term),
+        // size(). Bad lines are reported as path:line once every chunk is in.
+        template <typename Part>
+        bool parseTextBook(const std::string &path, ThreadPool &pool, std::vector<Part> &parts, LoadInfo *info)
+        {
+            parts.clear();
+            if (info)
+                info->clear();
+            FileBytes file;
+            if (!file.open(path))
+                return false;
+            if (file.size() == 0)
+                return true;
+            const char *data = file.data();
+            const char *end = data + file.size();
+
+            // rows estimated from the line length in the first 64 KB (+1/8
+            // slack), instead of a full pass counting newlines
+            std::size_t sampleBytes = std::min<std::size_t>(file.size(), 1 << 16);
+            std::size_t sampleLines = 1;
+            for (const char *q = data; (q = static_cast<const char *>(std::memchr(q, '\n', data + sampleBytes - q))); ++q)
+                ++sampleLines;
+
+            // chunk c is [cuts[c], cuts[c + 1]); inner cuts sit just past a newline
+            std::size_t chunks = pool.threadCount() == 1 ? 1 : std::min(pool.threadCount() * 4, file.size() / PARALLEL_LOAD_CHUNK);
+            std::vector<const char *> cuts{data};
+            for (std::size_t c = 1; c < chunks; ++c)
+            {
+                const char *from = std::max(data + file.size() / chunks * c, cuts.back());
+                const char *nl = static_cast<const char *>(std::memchr(from, '\n', end - from));
+                if (!nl || nl + 1 == end)
+                    break;
+                cuts.push_back(nl + 1);
+            }
+            cuts.push_back(end);
+            chunks = cuts.size() - 1;
+
+            parts.resize(chunks);
+            std::vector<ChunkReport> reports(chunks);
+            std::vector<std::vector<std::size_t>> hashes(info ? chunks : 0);
+            std::vector<std::size_t> nameBytes(chunks, 0);
+            forEachChunk(pool, chunks, [&](std::size_t c)
+                         {
+                std::size_t bytes = static_cast<std::size_t>(cuts[c + 1] - cuts[c]);
+                std::size_t rows = bytes / sampleBytes * sampleLines + sampleLines;
+                parts[c].reserve(rows + rows / 8);
+                if (info)
+                    hashes[c].reserve(rows + rows / 8);
+                parseLines(cuts[c], cuts[c + 1], reports[c],
+                           [&](std::string_view name, double amount, double rate, int term)
+                           {
+                               parts[c].add(name, amount, rate, term);
+                               if (info)
+                               {
+                                   hashes[c].push_back(std::hash<std::string_view>{}(name));
+                                   nameBytes[c] += name.size();
+                               }
+                           }); });
+
+            std::size_t lineBase = 0;
+            std::size_t badLines = 0;
+            for (const ChunkReport &report : reports)
+            {
+                reportBadLines(path, report, lineBase, badLines);
+                lineBase += report.lines;
+            }
+            reportSkippedLines(path, badLines);
+
+            if (info)
+            {
+                std::size_t rows = 0;
+                for (std::size_t c = 0; c < chunks; ++c)
+                {
+                    info->chunkRows.push_back(parts[c].size());
+                    info->nameBytes += nameBytes[c];
+                    rows += parts[c].size();
+                }
+                if (chunks == 1)
+                {
+                    info->nameHash.swap(hashes[0]);
+                }
+                else
+                {
+                    info->nameHash.resize(rows);
+                    forEachChunk(pool, chunks, [&](std::size_t c)
+                                 {
+                        std::size_t at = 0;
+                        for (std::size_t k = 0; k < c; ++k)
+                            at += info->chunkRows[k];
+                        std::copy(hashes[c].begin(), hashes[c].end(), info->nameHash.begin() + at); });
+                }
+            }
+            return true;
+        }
+
+        // first row of each part once they are laid end to end
+        template <typename Part>
+        std::vector<std::size_t> partOffsets(const std::vector<Part> &parts, std::size_t &total)
+        {
+            std::vector<std::size_t> at(parts.size());
+            total = 0;
+            for (std::size_t c = 0; c < parts.size(); ++c)
+            {
+                at[c] = total;
+                total += parts[c].size();
+            }
+            return at;
+        }
+
+        template <typename Cols, typename Record>
+        struct RecordPart
+        {
+            std::vector<Record> rows;
+
+            void reserve(std::size_t n) { rows.reserve(n); }
+            std::size_t size() const { return rows.size(); }
+            void add(std::string_view name, double amount, double rate, int term)
+            {
+                rows.emplace_back();
+                Record &r = rows.back();
+                r.name.assign(name);
+                Cols::amount(r) = amount;
+                Cols::rate(r) = rate;
+                Cols::term(r) = term;
+            }
+        };
+
+        template <typename Cols, typename Table>
+        struct TablePart
+        {
+            Table rows;
+
+            void reserve(std::size_t n) { rows.reserve(n); }
+            std::size_t size() const { return rows.size(); }
+            void add(std::string_view name, double amount, double rate, int term)
+            {
+                rows.name.emplace_back(name);
+                Cols::amount(rows).push_back(amount);
+                Cols::rate(rows).push_back(rate);
+                Cols::term(rows).push_back(term);
+            }
+        };
+
+        template <typename Cols, typename Record>
+        bool readTextRecords(std::vector<Record> &out, const std::string &path, ThreadPool &pool, LoadInfo *info)
+        {
+            out.clear();
+            std::vector<RecordPart<Cols, Record>> parts;
+            if (!parseTextBook(path, pool, parts, info))
+                return false;
+            if (parts.size() == 1)
+            {
+                out.swap(parts[0].rows);
+                return true;
+            }
+
+            std::size_t total;
+            std::vector<std::size_t> at = partOffsets(parts, total);
+            out.resize(total);
+            forEachChunk(pool, parts.size(), [&](std::size_t c)
+                         { std::move(parts[c].rows.begin(), parts[c].rows.end(), out.begin() + at[c]); });
+            return true;
+        }
+
+        template <typename Cols, typename Table>
+        bool readTextTable(Table &t, const std::string &path, ThreadPool &pool, LoadInfo *info)
+        {
+            t.clear();
+            std::vector<TablePart<Cols, Table>> parts;
+            if (!parseTextBook(path, pool, parts, info))
+                return false;
+            if (parts.size() == 1)
+            {
+                std::swap(t, parts[0].rows);
+                return true;
+            }
+
+            std::size_t total;
+            std::vector<std::size_t> at = partOffsets(parts, total);
+            t.name.resize(total);
+            Cols::amount(t).resize(total);
+            Cols::rate(t).resize(total);
+            Cols::term(t).resize(total);
+            forEachChunk(pool, parts.size(), [&](std::size_t c)
+                         {
+                Table &part = parts[c].rows;
+                std::move(part.name.begin(), part.name.end(), t.name.begin() + at[c]);
+                std::copy(Cols::amount(part).begin(), Cols::amount(part).end(), Cols::amount(t).begin() + at[c]);
+                std::copy(Cols::rate(part).begin(), Cols::rate(part).end(), Cols::rate(t).begin() + at[c]);
+                std::copy(Cols::term(part).begin(), Cols::term(part).end(), Cols::term(t).begin() + at[c]); });
+            return true;
+        }
+
+        // shortest of %.15g / %.17g that reads back as the same double
+        void appendNumber(std::string &out, double v)
+        {
+            char buf[32];
+            int n = std::snprintf(buf, sizeof buf, "%.15g", v);
+            double back;
+            if (!parseNumber(std::string_view(buf, n), back) || !(back == v))
+                n = std::snprintf(buf, sizeof buf, "%.17g", v);
+            out.append(buf, n);
+        }
+
+        // "name amount rate term" lines that read back to the same values
+        template <typename Cols, typename Record>
+        bool writeTextSnapshot(int fd, const std::vector<Record> &records)
+        {
+            FdWriter out(fd);
+            for (const Record &r : records)
+            {
+                out.buf += r.name;
+                out.buf += ' ';
+                appendNumber(out.buf, Cols::amount(r));
+                out.buf += ' ';
+                appendNumber(out.buf, Cols::rate(r));
+                out.buf += ' ';
+                out.buf += std::to_string(Cols::term(r));
+                out.buf += '\n';
+                out.spill();
+            }
+            return out.flush();
         }
-        return true;
     }
 
-    bool loadDeposits(std::vector<Deposit> &deps, const std::string &path)
+    // ----- binary columnar files -----
+    bool isColumnFile(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof COLUMN_MAGIC];
+        return in.read(magic, sizeof magic) && std::memcmp(magic, COLUMN_MAGIC, sizeof magic) == 0;
+    }
+
+    MappedColumns::~MappedColumns()
     {
-        std::ifstream in(path);
-        if (!in)
+        close();
+    }
+
+    void MappedColumns::close()
+    {
+        if (map_)
+            munmap(map_, mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+        rows_ = 0;
+    }
+
+    bool MappedColumns::open(const std::string &path, BookKind kind)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
             return false;
-        deps.clear();
-        Deposit d;
-        while (in >> d.name >> d.amount >> d.rate >> d.months)
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) < sizeof(ColumnFileHeader))
         {
-            deps.push_back(d);
+            ::close(fd);
+            return false;
         }
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (map == MAP_FAILED)
+            return false;
+        map_ = map;
+        mapSize_ = size;
+
+        const char *base = static_cast<const char *>(map);
+        ColumnFileHeader h;
+        std::memcpy(&h, base, sizeof h);
+
+        // a section is usable if it is aligned and ends inside the file
+        auto fits = [size](std::uint64_t off, std::uint64_t bytes)
+        {
+            return off % 8 == 0 && off <= size && bytes <= size - off;
+        };
+        bool ok = std::memcmp(h.magic, COLUMN_MAGIC, sizeof h.magic) == 0 &&
+                  h.version == COLUMN_FILE_VERSION &&
+                  h.byteOrder == COLUMN_FILE_BYTE_ORDER &&
+                  h.kind == static_cast<std::uint32_t>(kind) &&
+                  h.fileSize == size &&
+                  h.rows < size / sizeof(std::int32_t) &&
+                  fits(h.nameOffsets, (h.rows + 1) * sizeof(std::uint64_t)) &&
+                  fits(h.amount, h.rows * sizeof(double)) &&
+                  fits(h.rate, h.rows * sizeof(double)) &&
+                  fits(h.term, h.rows * sizeof(std::int32_t)) &&
+                  h.heap <= size && h.heapSize <= size - h.heap;
+        if (ok)
+        {
+            // offsets must climb from 0 to heapSize, or name() could read
+            // outside the heap
+            const std::uint64_t *offsets = reinterpret_cast<const std::uint64_t *>(base + h.nameOffsets);
+            ok = offsets[0] == 0 && offsets[h.rows] == h.heapSize;
+            for (std::uint64_t i = 0; ok && i < h.rows; ++i)
+                ok = offsets[i] <= offsets[i + 1];
+        }
+        if (!ok)
+        {
+            close();
+            return false;
+        }
+
+        rows_ = static_cast<std::size_t>(h.rows);
+        nameOffsets_ = reinterpret_cast<const std::uint64_t *>(base + h.nameOffsets);
+        amount_ = reinterpret_cast<const double *>(base + h.amount);
+        rate_ = reinterpret_cast<const double *>(base + h.rate);
+        term_ = reinterpret_cast<const std::int32_t *>(base + h.term);
+        heap_ = base + h.heap;
         return true;
     }
 
-    bool saveCredits(const std::vector<CreditRecord> &creds, const std::string &path)
+    // ----- tables -----
+    bool loadDeposits(DepositTable &deps, const std::string &path)
     {
-        std::ofstream out(path);
-        if (!out)
-            return false;
-        for (const auto &c : creds)
+        return loadDeposits(deps, path, ThreadPool::shared());
+    }
+
+    bool loadDeposits(DepositTable &deps, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
         {
-            out << c.name << " "
-                << c.amount << " "
-                << c.interest << " "
-                << c.months << "\n";
+            if (info)
+                info->clear();
+            return readColumnTable<DepositColumns>(deps, path);
         }
-        return true;
+        return readTextTable<DepositColumns>(deps, path, pool, info);
+    }
+
+    bool saveDepositsBinary(const DepositTable &deps, const std::string &path)
+    {
+        return saveAtomically(path, [&](int fd)
+                              { return writeColumnFile<DepositColumns>(deps, fd); });
+    }
+
+    bool loadCredits(CreditTable &creds, const std::string &path)
+    {
+        return loadCredits(creds, path, ThreadPool::shared());
+    }
+
+    bool loadCredits(CreditTable &creds, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
+        {
+            if (info)
+                info->clear();
+            return readColumnTable<CreditColumns>(creds, path);
+        }
+        return readTextTable<CreditColumns>(creds, path, pool, info);
+    }
+
+    bool saveCreditsBinary(const CreditTable &creds, const std::string &path)
+    {
+        return saveAtomically(path, [&](int fd)
+                              { return writeColumnFile<CreditColumns>(creds, fd); });
+    }
+
+    bool loadLoans(LoanTable &loans, const std::string &path)
+    {
+        return loadLoans(loans, path, ThreadPool::shared());
+    }
+
+    bool loadLoans(LoanTable &loans, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
+        {
+            if (info)
+                info->clear();
+            return readColumnTable<LoanColumns>(loans, path);
+        }
+        return readTextTable<LoanColumns>(loans, path, pool, info);
+    }
+
+    bool saveLoansBinary(const LoanTable &loans, const std::string &path)
+    {
+        return saveAtomically(path, [&](int fd)
+                              { return writeColumnFile<LoanColumns>(loans, fd); });
+    }
+
+    // ----- text files -----
+    bool saveDeposits(const std::vector<Deposit> &deps, const std::string &path)
+    {
+        return saveAtomically(path, [&](int fd)
+                              { return writeTextSnapshot<DepositColumns>(fd, deps); });
+    }
+
+    bool loadDeposits(std::vector<Deposit> &deps, const std::string &path)
+    {
+        return loadDeposits(deps, path, ThreadPool::shared());
+    }
+
+    bool loadDeposits(std::vector<Deposit> &deps, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
+        {
+            if (info)
+                info->clear();
+            return readColumnRecords<DepositColumns>(deps, path);
+        }
+        return readTextRecords<DepositColumns>(deps, path, pool, info);
+    }
+
+    bool saveCredits(const std::vector<CreditRecord> &creds, const std::string &path)
+    {
+        return saveAtomically(path, [&](int fd)
+                              { return writeTextSnapshot<CreditColumns>(fd, creds); });
     }
 
     bool loadCredits(std::vector<CreditRecord> &creds, const std::string &path)
     {
-        std::ifstream in(path);
-        if (!in)
-            return false;
-        creds.clear();
-        CreditRecord c;
-        while (in >> c.name >> c.amount >> c.interest >> c.months)
+        return loadCredits(creds, path, ThreadPool::shared());
+    }
+
+    bool loadCredits(std::vector<CreditRecord> &creds, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
         {
-            creds.push_back(c);
+            if (info)
+                info->clear();
+            return readColumnRecords<CreditColumns>(creds, path);
         }
-        return true;
+        return readTextRecords<CreditColumns>(creds, path, pool, info);
     }
 
     bool saveLoans(const std::vector<Loan> &loans, const std::string &path)
     {
-        std::ofstream out(path);
-        if (!out)
+        return saveAtomically(path, [&](int fd)
+                              { return writeTextSnapshot<LoanColumns>(fd, loans); });
+    }
+
+    bool loadLoans(std::vector<Loan> &loans, const std::string &path)
+    {
+        return loadLoans(loans, path, ThreadPool::shared());
+    }
+
+    bool loadLoans(std::vector<Loan> &loans, const std::string &path, ThreadPool &pool, LoadInfo *info)
+    {
+        if (isColumnFile(path))
+        {
+            if (info)
+                info->clear();
+            return readColumnRecords<LoanColumns>(loans, path);
+        }
+        return readTextRecords<LoanColumns>(loans, path, pool, info);
+    }
+
+    // ----- streaming batches -----
+    namespace
+    {
+        template <typename Table>
+        struct TableColumns;
+
+        template <>
+        struct TableColumns<DepositTable>
+        {
+            using type = DepositColumns;
+        };
+
+        template <>
+        struct TableColumns<LoanTable>
+        {
+            using type = LoanColumns;
+        };
+
+        template <>
+        struct TableColumns<CreditTable>
+        {
+            using type = CreditColumns;
+        };
+    }
+
+    template <typename Table>
+    BatchReader<Table>::BatchReader(std::size_t batchRows)
+        : batchRows_(batchRows == 0 ? 1 : batchRows), buf_(BATCH_READ_BLOCK)
+    {
+    }
+
+    template <typename Table>
+    BatchReader<Table>::~BatchReader()
+    {
+        if (fd_ > 0)
+            ::close(fd_);
+    }
+
+    template <typename Table>
+    bool BatchReader<Table>::open(const std::string &path)
+    {
+        path_ = path == "-" ? std::string("<stdin>") : path;
+        fd_ = path == "-" ? 0 : ::open(path.c_str(), O_RDONLY);
+        return fd_ >= 0;
+    }
+
+    // moves the unparsed tail to the front and reads behind it; a line
+    // longer than the whole block doubles the block
+    template <typename Table>
+    void BatchReader<Table>::fill()
+    {
+        if (begin_ > 0)
+        {
+            std::memmove(buf_.data(), buf_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (end_ == buf_.size())
+            buf_.resize(buf_.size() * 2);
+        while (true)
+        {
+            ssize_t got = ::read(fd_, buf_.data() + end_, buf_.size() - end_);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got < 0)
+            {
+                std::cerr << path_ << ": " << std::strerror(errno) << "\n";
+                failed_ = true;
+            }
+            if (got <= 0)
+                eof_ = true;
+            else
+                end_ += static_cast<std::size_t>(got);
+            return;
+        }
+    }
+
+    template <typename Table>
+    bool BatchReader<Table>::next(Table &batch)
+    {
+        using Cols = typename TableColumns<Table>::type;
+        batch.clear();
+        if (fd_ < 0)
             return false;
-        for (const auto &l : loans)
+        batch.reserve(batchRows_);
+
+        while (batch.size() < batchRows_)
         {
-            out << l.name << " "
-                << l.principal << " "
-                << l.rate << " "
-                << l.years << "\n";
+            // up to the rows still wanted, in whole lines (the last line
+            // of the input may lack its newline)
+            const char *p = buf_.data() + begin_;
+            const char *e = buf_.data() + end_;
+            const char *q = p;
+            for (std::size_t lines = batch.size(); lines < batchRows_; ++lines)
+            {
+                const char *nl = static_cast<const char *>(std::memchr(q, '\n', e - q));
+                if (!nl)
+                    break;
+                q = nl + 1;
+            }
+            if (q == p)
+            {
+                if (!eof_)
+                {
+                    fill();
+                    continue;
+                }
+                if (p == e)
+                    break;
+                q = e;
+            }
+
+            ChunkReport report;
+            parseLines(p, q, report, [&](std::string_view name, double amount, double rate, int term)
+                       {
+                batch.name.emplace_back(name);
+                Cols::amount(batch).push_back(amount);
+                Cols::rate(batch).push_back(rate);
+                Cols::term(batch).push_back(term); });
+            reportBadLines(path_, report, lineBase_, badLines_);
+            lineBase_ += report.lines;
+            begin_ += static_cast<std::size_t>(q - p);
         }
-        return true;
+
+        if (batch.empty())
+        {
+            reportSkippedLines(path_, badLines_);
+            badLines_ = 0;
+        }
+        return !batch.empty();
     }
 
-    bool loadLoans(std::vector<Loan> &loans, const std::string &path)
+    template class BatchReader<DepositTable>;
+    template class BatchReader<LoanTable>;
+    template class BatchReader<CreditTable>;
+
+    // ----- write-ahead journal -----
+    namespace
     {
-        std::ifstream in(path);
-        if (!in)
+        template <typename Record>
+        struct BookOf;
+
+        template <>
+        struct BookOf<Deposit>
+        {
+            using Cols = DepositColumns;
+            using Table = DepositTable;
+            static bool load(std::vector<Deposit> &v, const std::string &path, LoadInfo *info)
+            {
+                return loadDeposits(v, path, ThreadPool::shared(), info);
+            }
+        };
+
+        template <>
+        struct BookOf<Loan>
+        {
+            using Cols = LoanColumns;
+            using Table = LoanTable;
+            static bool load(std::vector<Loan> &v, const std::string &path, LoadInfo *info)
+            {
+                return loadLoans(v, path, ThreadPool::shared(), info);
+            }
+        };
+
+        template <>
+        struct BookOf<CreditRecord>
+        {
+            using Cols = CreditColumns;
+            using Table = CreditTable;
+            static bool load(std::vector<CreditRecord> &v, const std::string &path, LoadInfo *info)
+            {
+                return loadCredits(v, path, ThreadPool::shared(), info);
+            }
+        };
+
+        const char JOURNAL_HEADER[] = "#fincalc-journal 1 ";
+
+        std::string generationPath(const std::string &book, std::uint64_t gen)
+        {
+            return book + ".journal." + std::to_string(gen);
+        }
+
+        // generations present next to the book, ascending
+        std::vector<std::uint64_t> listGenerations(const std::string &book)
+        {
+            std::vector<std::uint64_t> gens;
+            std::size_t slash = book.rfind('/');
+            std::string prefix = (slash == std::string::npos ? book : book.substr(slash + 1)) + ".journal.";
+            DIR *dir = opendir(dirOf(book).c_str());
+            if (!dir)
+                return gens;
+            while (dirent *ent = readdir(dir))
+            {
+                std::string_view name(ent->d_name);
+                if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0)
+                    continue;
+                std::string_view digits = name.substr(prefix.size());
+                std::uint64_t gen;
+                auto res = std::from_chars(digits.data(), digits.data() + digits.size(), gen);
+                if (res.ec == std::errc() && res.ptr == digits.data() + digits.size())
+                    gens.push_back(gen);
+            }
+            closedir(dir);
+            // a handful of files: insertion sort
+            for (std::size_t i = 1; i < gens.size(); ++i)
+                for (std::size_t j = i; j > 0 && gens[j] < gens[j - 1]; --j)
+                    std::swap(gens[j], gens[j - 1]);
+            return gens;
+        }
+
+        std::string_view nextToken(std::string_view &line)
+        {
+            std::size_t sp = line.find(' ');
+            std::string_view tok = line.substr(0, sp);
+            line = sp == std::string_view::npos ? std::string_view() : line.substr(sp + 1);
+            return tok;
+        }
+
+        // " amount rate term name": numbers first, so the name is the rest
+        // of the line verbatim (spaces, or even empty)
+        template <typename Cols, typename Record>
+        void appendRecord(std::string &out, const Record &r)
+        {
+            out += ' ';
+            appendNumber(out, Cols::amount(r));
+            out += ' ';
+            appendNumber(out, Cols::rate(r));
+            out += ' ';
+            out += std::to_string(Cols::term(r));
+            out += ' ';
+            out += r.name;
+        }
+
+        template <typename Cols, typename Record>
+        bool parseRecord(std::string_view rest, Record &r)
+        {
+            double amount, rate;
+            int term;
+            if (!parseNumber(nextToken(rest), amount) || !parseNumber(nextToken(rest), rate))
+                return false;
+            std::size_t sp = rest.find(' ');
+            if (sp == std::string_view::npos || !parseNumber(rest.substr(0, sp), term))
+                return false;
+            r.name.assign(rest.substr(sp + 1));
+            Cols::amount(r) = amount;
+            Cols::rate(r) = rate;
+            Cols::term(r) = term;
+            return true;
+        }
+
+        // Applies one journal line. false if it is malformed or its index
+        // does not exist, which means the journal does not belong to this book.
+        template <typename Cols, typename Record>
+        bool applyEntry(std::string_view line, std::vector<Record> &records)
+        {
+            std::string_view op = nextToken(line);
+            if (op == "A")
+            {
+                Record r;
+                if (!parseRecord<Cols>(line, r))
+                    return false;
+                records.push_back(std::move(r));
+                return true;
+            }
+            if (op == "R")
+            {
+                records.clear();
+                return line.empty();
+            }
+
+            std::size_t idx;
+            std::string_view idxTok = nextToken(line);
+            auto res = std::from_chars(idxTok.data(), idxTok.data() + idxTok.size(), idx);
+            if (res.ec != std::errc() || res.ptr != idxTok.data() + idxTok.size() || idx >= records.size())
+                return false;
+            if (op == "U")
+                return parseRecord<Cols>(line, records[idx]);
+            if (op == "D")
+            {
+                if (!line.empty())
+                    return false;
+                if (idx != records.size() - 1)
+                    records[idx] = std::move(records.back());
+                records.pop_back();
+                return true;
+            }
             return false;
-        loans.clear();
-        Loan l;
-        while (in >> l.name >> l.principal >> l.rate >> l.years)
+        }
+
+        // Replays one generation file. Sets base to the snapshot named in its
+        // header; a missing trailing newline is a write that never returned,
+        // so that tail is cut off. Returns the entries applied, or -1 at the
+        // first bad line (entries before it stay applied).
+        template <typename Cols, typename Record>
+        long long replayGeneration(const std::string &path, std::vector<Record> &records,
+                                   std::uint64_t &baseDev, std::uint64_t &baseIno, bool headerOnly)
         {
-            loans.push_back(l);
+            FileBytes file;
+            if (!file.open(path))
+                return -1;
+            std::string_view text(file.data(), file.size());
+
+            std::size_t lastNl = text.rfind('\n');
+            if (lastNl == std::string_view::npos)
+                return -1; // not even a complete header
+            if (lastNl + 1 != text.size())
+            {
+                if (truncate(path.c_str(), static_cast<off_t>(lastNl + 1)) != 0)
+                    std::cerr << path << ": could not cut torn entry\n";
+                text = text.substr(0, lastNl + 1);
+            }
+
+            std::size_t nl = text.find('\n');
+            std::string_view header = text.substr(0, nl);
+            std::string_view rest = text.substr(nl + 1);
+            if (header.compare(0, sizeof JOURNAL_HEADER - 1, JOURNAL_HEADER) != 0)
+                return -1;
+            header.remove_prefix(sizeof JOURNAL_HEADER - 1);
+            std::string_view devTok = nextToken(header);
+            auto r1 = std::from_chars(devTok.data(), devTok.data() + devTok.size(), baseDev);
+            auto r2 = std::from_chars(header.data(), header.data() + header.size(), baseIno);
+            if (r1.ec != std::errc() || r2.ec != std::errc() || r2.ptr != header.data() + header.size())
+                return -1;
+            if (headerOnly)
+                return 0;
+
+            long long applied = 0;
+            std::size_t lineNo = 1;
+            while (!rest.empty())
+            {
+                ++lineNo;
+                nl = rest.find('\n');
+                std::string_view line = rest.substr(0, nl);
+                rest.remove_prefix(nl + 1);
+                if (!applyEntry<Cols>(line, records))
+                {
+                    std::cerr << path << ":" << lineNo << ": bad journal entry, replay stopped\n";
+                    return -1;
+                }
+                ++applied;
+            }
+            return applied;
+        }
+    }
+
+    template <typename Record>
+    Journal<Record>::Journal(std::string bookPath) : book_(std::move(bookPath)) {}
+
+    template <typename Record>
+    Journal<Record>::~Journal()
+    {
+        wait();
+        closeGeneration();
+    }
+
+    template <typename Record>
+    void Journal<Record>::wait()
+    {
+        if (compactor_.joinable())
+            compactor_.join();
+    }
+
+    template <typename Record>
+    void Journal<Record>::closeGeneration()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+    template <typename Record>
+    bool Journal<Record>::load(std::vector<Record> &records, LoadInfo *info)
+    {
+        using Cols = typename BookOf<Record>::Cols;
+        wait();
+        closeGeneration();
+        records.clear();
+
+        bool ok = true;
+        std::uint64_t dev = 0, ino = 0; // 0/0: no book yet
+        struct stat st;
+        if (stat(book_.c_str(), &st) == 0)
+        {
+            dev = static_cast<std::uint64_t>(st.st_dev);
+            ino = static_cast<std::uint64_t>(st.st_ino);
+            binary_ = isColumnFile(book_);
+            ok = BookOf<Record>::load(records, book_, info);
         }
+        else if (info)
+        {
+            info->clear();
+        }
+
+        // Journals written before the book's current snapshot was installed
+        // are already in it. Replay starts at the first generation written
+        // against this snapshot and carries on through the later ones (a
+        // compaction that never got renamed in leaves its successor pointing
+        // at the unfinished snapshot; those entries still follow on).
+        std::vector<std::uint64_t> gens = listGenerations(book_);
+        bool replaying = false, broken = false;
+        entries_ = 0;
+        for (std::uint64_t gen : gens)
+        {
+            std::string path = generationPath(book_, gen);
+            std::uint64_t genDev = 0, genIno = 0;
+            long long applied = broken ? 0 : replayGeneration<Cols>(path, records, genDev, genIno, !replaying);
+            if (!replaying && !broken && applied == 0 && genDev == dev && genIno == ino)
+            {
+                replaying = true;
+                applied = replayGeneration<Cols>(path, records, genDev, genIno, false);
+            }
+            if (!replaying)
+            {
+                ::unlink(path.c_str()); // stale: already part of the book
+                continue;
+            }
+            if (applied < 0)
+                broken = true;
+            else
+                entries_ += static_cast<std::size_t>(applied);
+        }
+
+        // keep appending to the last generation when it replayed cleanly
+        gen_ = gens.empty() ? 1 : gens.back() + (replaying && !broken ? 0 : 1);
+        baseDev_ = dev;
+        baseIno_ = ino;
+        if (info && entries_ > 0)
+            info->clear(); // rows moved since the book was parsed
+        if (broken)
+            compact(records); // a fresh snapshot of what was recovered supersedes the rest
+        return ok;
+    }
+
+    template <typename Record>
+    bool Journal<Record>::append(const std::string &lines, std::size_t count)
+    {
+        if (fd_ < 0)
+        {
+            std::string path = generationPath(book_, gen_);
+            fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+            if (fd_ < 0)
+            {
+                std::cerr << path << ": " << std::strerror(errno) << "\n";
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && st.st_size == 0)
+            {
+                std::string header = JOURNAL_HEADER + std::to_string(baseDev_) + " " + std::to_string(baseIno_) + "\n";
+                if (!writeAll(fd_, header.data(), header.size()) || !syncData(fd_))
+                {
+                    std::cerr << path << ": " << std::strerror(errno) << "\n";
+                    closeGeneration();
+                    return false;
+                }
+                syncDir(path);
+            }
+        }
+        if (!writeAll(fd_, lines.data(), lines.size()) || !syncData(fd_))
+        {
+            std::cerr << generationPath(book_, gen_) << ": " << std::strerror(errno) << "\n";
+            return false;
+        }
+        entries_ += count;
         return true;
     }
+
+    template <typename Record>
+    bool Journal<Record>::add(const Record &r)
+    {
+        std::string line = "A";
+        appendRecord<typename BookOf<Record>::Cols>(line, r);
+        line += '\n';
+        return append(line, 1);
+    }
+
+    template <typename Record>
+    bool Journal<Record>::update(std::size_t idx, const Record &r)
+    {
+        std::string line = "U " + std::to_string(idx);
+        appendRecord<typename BookOf<Record>::Cols>(line, r);
+        line += '\n';
+        return append(line, 1);
+    }
+
+    template <typename Record>
+    bool Journal<Record>::remove(std::size_t idx)
+    {
+        return append("D " + std::to_string(idx) + "\n", 1);
+    }
+
+    template <typename Record>
+    bool Journal<Record>::replaceAll(const std::vector<Record> &records)
+    {
+        std::string lines = "R\n";
+        for (const Record &r : records)
+        {
+            lines += 'A';
+            appendRecord<typename BookOf<Record>::Cols>(lines, r);
+            lines += '\n';
+        }
+        return append(lines, records.size() + 1);
+    }
+
+    template <typename Record>
+    void Journal<Record>::maybeCompact(const std::vector<Record> &records)
+    {
+        if (compactorDone_ && entries_ >= JOURNAL_COMPACT_MIN_ENTRIES && entries_ * 4 >= records.size())
+            compact(records);
+    }
+
+    template <typename Record>
+    void Journal<Record>::checkpoint(const std::vector<Record> &records)
+    {
+        if (dirty())
+            compact(records);
+    }
+
+    // The snapshot's file is created here, so its inode is known before any
+    // later write: the next generation names it as its base. Writing,
+    // syncing and renaming it over the book then happen off this thread
+    // on a copy of the records.
+    template <typename Record>
+    void Journal<Record>::compact(const std::vector<Record> &records)
+    {
+        using Cols = typename BookOf<Record>::Cols;
+        using Table = typename BookOf<Record>::Table;
+        wait();
+
+        int fd = createTemp(book_);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0)
+        {
+            std::cerr << tempPath(book_) << ": " << std::strerror(errno) << "\n";
+            if (fd >= 0)
+                ::close(fd);
+            return;
+        }
+
+        closeGeneration();
+        std::uint64_t compacted = gen_++;
+        baseDev_ = static_cast<std::uint64_t>(st.st_dev);
+        baseIno_ = static_cast<std::uint64_t>(st.st_ino);
+        entries_ = 0;
+
+        compactorDone_ = false;
+        compactor_ = std::thread(
+            [this, fd, compacted, binary = binary_, snapshot = records]()
+            {
+                bool written = binary ? writeColumnFile<Cols>(Table::from(snapshot), fd)
+                                      : writeTextSnapshot<Cols>(fd, snapshot);
+                if (installTemp(fd, written, book_))
+                {
+                    for (std::uint64_t gen : listGenerations(book_))
+                        if (gen <= compacted)
+                            ::unlink(generationPath(book_, gen).c_str());
+                }
+                else
+                {
+                    std::cerr << book_ << ": snapshot failed, journal kept\n";
+                }
+                compactorDone_ = true;
+            });
+    }
+
+    template class Journal<Deposit>;
+    template class Journal<Loan>;
+    template class Journal<CreditRecord>;
 }